@@ -0,0 +1,98 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <print>
+#include <random>
+#include <thread>
+#include <vector>
+#include "sugar_concurrent_lazytable.h"
+
+using namespace libsugarx;
+
+/*
+read-mostly workload (90% lookups, 10% emplace/lazy_remove)
+on a single mutex-wrapped lazy_flat_table and on the sharded table,
+for 1, 2, 4, ... hardware_concurrency threads.
+*/
+
+constexpr std::size_t KeyCount = 1 << 20;
+constexpr std::size_t OpsPerThread = 1 << 21;
+
+struct locked_table
+{
+	std::mutex mutex;
+	lazy_flat_table<std::uint64_t, std::uint64_t> table;
+
+	bool contains(std::uint64_t key)
+	{
+		std::lock_guard lock(mutex);
+		return table.contains(key);
+	}
+
+	void emplace(std::uint64_t key, std::uint64_t value)
+	{
+		std::lock_guard lock(mutex);
+		table.emplace(key, value);
+	}
+
+	void lazy_remove(std::uint64_t key)
+	{
+		std::lock_guard lock(mutex);
+		table.lazy_remove(key);
+	}
+};
+
+template<typename Table>
+double run(Table &table, std::size_t threads)
+{
+	std::atomic<std::size_t> hits{0};
+	auto worker = [&table, &hits](std::size_t seed) {
+		std::mt19937_64 random(seed);
+		std::size_t local_hits = 0;
+		for(std::size_t i = 0; i < OpsPerThread; ++i)
+		{
+			std::uint64_t key = random() % KeyCount;
+			// drawn apart from the key, so every key sees the same mix of operations
+			std::uint64_t op = random() % 20;
+			if(op == 0)
+				table.emplace(key, i);
+			else if(op == 1)
+				table.lazy_remove(key);
+			else
+				local_hits += table.contains(key);
+		}
+		hits += local_hits;
+	};
+
+	auto begin = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+	for(std::size_t i = 0; i < threads; ++i)
+		workers.emplace_back(worker, i + 1);
+	for(std::thread &thread : workers)
+		thread.join();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+	return static_cast<double>(threads * OpsPerThread) / elapsed.count();
+}
+
+int main(int argc, char **argv)
+{
+	std::size_t max_threads = std::max(1U, std::thread::hardware_concurrency());
+	std::println("threads,single_mutex_mops,sharded_mops");
+	for(std::size_t threads = 1; threads <= max_threads; threads *= 2)
+	{
+		locked_table single;
+		concurrent_lazy_flat_table<std::uint64_t, std::uint64_t> sharded;
+		single.table.reserve(KeyCount);
+		sharded.reserve(KeyCount);
+		for(std::uint64_t key = 0; key < KeyCount; key += 2)
+		{
+			single.table.emplace(key, key);
+			sharded.emplace(key, key);
+		}
+
+		double single_ops = run(single, threads);
+		double sharded_ops = run(sharded, threads);
+		std::println("{},{:.2f},{:.2f}", threads, single_ops / 1e6, sharded_ops / 1e6);
+	}
+}
@@ -0,0 +1,123 @@
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <openssl/evp.h>
+#include "sugar_digest.h"
+#include "sugar_uuid.h"
+
+using namespace libsugarx;
+
+/*
+sugar_digest.h MD5/SHA-1 against OpenSSL's EVP_Digest over several message sizes in MB/s,
+then million v3/v5 UUIDs per second for short names:
+the previous per-call EVP code, uuid::generate_v3/v5 and uuid_name_generator.
+build with -march=native (or -msha -mssse3) to get the SHA-NI path.
+prints CSV.
+*/
+
+constexpr std::size_t BytesPerRun = 1 << 27;
+constexpr std::size_t NameCount = 1 << 20;
+
+// keeps results alive so hashing isn't optimized out
+inline volatile std::uint64_t sink = 0;
+
+template<typename Fn>
+double seconds(Fn &&fn)
+{
+	auto begin = std::chrono::steady_clock::now();
+	fn();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+	return elapsed.count();
+}
+
+template<typename Digest>
+double sugarx_mbs(const std::string &message)
+{
+	std::size_t rounds = std::max<std::size_t>(BytesPerRun / message.size(), 1);
+	std::uint64_t sum = 0;
+	double elapsed = seconds([&] {
+		for(std::size_t i = 0; i < rounds; ++i)
+			sum += static_cast<unsigned char>(Digest::hash(message)[0]);
+	});
+	sink = sink + sum;
+	return static_cast<double>(rounds * message.size()) / elapsed / 1e6;
+}
+
+double openssl_mbs(const EVP_MD *md, const std::string &message)
+{
+	std::size_t rounds = std::max<std::size_t>(BytesPerRun / message.size(), 1);
+	std::uint64_t sum = 0;
+	double elapsed = seconds([&] {
+		for(std::size_t i = 0; i < rounds; ++i)
+		{
+			std::array<unsigned char, EVP_MAX_MD_SIZE> digest;
+			EVP_Digest(message.data(), message.size(), digest.data(), nullptr, md, nullptr);
+			sum += digest[0];
+		}
+	});
+	sink = sink + sum;
+	return static_cast<double>(rounds * message.size()) / elapsed / 1e6;
+}
+
+// what uuid::generate_v3/v5 did before sugar_digest.h
+uuid openssl_name_based(const EVP_MD *md, std::string_view name, const uuid &name_space, int version)
+{
+	uuid result;
+	EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+	std::array<unsigned char, EVP_MAX_MD_SIZE> digest;
+	EVP_DigestInit(ctx, md);
+	EVP_DigestUpdate(ctx, name_space.raw_data().data(), name_space.raw_data().size());
+	EVP_DigestUpdate(ctx, name.data(), name.size());
+	EVP_DigestFinal(ctx, digest.data(), nullptr);
+	EVP_MD_CTX_free(ctx);
+	std::memcpy(result.raw_data().data(), digest.data(), 16);
+	result.raw_data()[6] = std::byte((static_cast<unsigned char>(result.raw_data()[6]) & 0x0F) | (version << 4));
+	result.raw_data()[8] = std::byte((static_cast<unsigned char>(result.raw_data()[8]) & 0x3F) | 0x80);
+	return result;
+}
+
+int main(int argc, char **argv)
+{
+	std::mt19937_64 random(24);
+	std::println("digest,bytes,openssl_mbs,sugarx_mbs");
+	for(std::size_t size : {16, 64, 256, 4096, 65536})
+	{
+		std::string message(size, '\0');
+		for(char &c : message)
+			c = static_cast<char>(random());
+		std::println("md5,{},{:.1f},{:.1f}", size, openssl_mbs(EVP_md5(), message), sugarx_mbs<md5>(message));
+		std::println("sha1,{},{:.1f},{:.1f}", size, openssl_mbs(EVP_sha1(), message), sugarx_mbs<sha1>(message));
+	}
+
+	std::vector<std::string> names(NameCount);
+	for(std::size_t i = 0; i < names.size(); ++i)
+		names[i] = "host-" + std::to_string(i) + ".example.com";
+
+	std::println("version,openssl_mups,sugarx_mups,generator_mups");
+	for(int version : {3, 5})
+	{
+		const EVP_MD *md = version == 3 ? EVP_md5() : EVP_sha1();
+		uuid_name_generator generator(uuid_namespace_dns, version);
+		std::uint64_t sum = 0;
+		double openssl = seconds([&] {
+			for(const std::string &name : names)
+				sum += static_cast<unsigned char>(openssl_name_based(md, name, uuid_namespace_dns, version).raw_data()[0]);
+		});
+		double sugarx = seconds([&] {
+			for(const std::string &name : names)
+				sum += static_cast<unsigned char>((version == 3 ? uuid::generate_v3(name, uuid_namespace_dns) : uuid::generate_v5(name, uuid_namespace_dns)).raw_data()[0]);
+		});
+		double prehashed = seconds([&] {
+			for(const std::string &name : names)
+				sum += static_cast<unsigned char>(generator.generate(name).raw_data()[0]);
+		});
+		sink = sink + sum;
+		std::println("{},{:.2f},{:.2f},{:.2f}", version, NameCount / openssl / 1e6, NameCount / sugarx / 1e6, NameCount / prehashed / 1e6);
+	}
+}
@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "sugar_lazytable.h"
+
+using namespace libsugarx;
+
+/*
+lazy_flat_table against std::unordered_map.
+
+usage: lazytable_benchmark [--entries N] [--key-bytes 8|16|32] [--value-bytes 8|32|128] [--seed S] [--json]
+
+one result per line, CSV by default or JSON lines with --json:
+container, workload, key_bytes, value_bytes, entries, ns_per_op, bytes_per_entry
+*/
+
+template<std::size_t N>
+struct blob
+{
+	static_assert(N % 8 == 0, "blob size must be a multiple of 8.");
+	std::array<std::uint64_t, N / 8> words{};
+
+	blob() = default;
+	explicit blob(std::uint64_t seed) { words.fill(seed); }
+
+	bool operator==(const blob &other) const = default;
+};
+
+template<std::size_t N>
+struct blob_hash
+{
+	std::size_t operator()(const blob<N> &value) const noexcept
+	{
+		std::uint64_t h = 0;
+		for(std::uint64_t word : value.words)
+			h = (h ^ word) * 0x9E3779B97F4A7C15ULL;
+		return static_cast<std::size_t>(h);
+	}
+};
+
+// counts bytes held by std::unordered_map, lazy_flat_table reports its own
+inline std::size_t counted_bytes = 0;
+
+template<typename T>
+struct counting_allocator
+{
+	using value_type = T;
+
+	counting_allocator() = default;
+	template<typename U>
+	counting_allocator(const counting_allocator<U> &) noexcept {}
+
+	T *allocate(std::size_t n)
+	{
+		counted_bytes += n * sizeof(T);
+		return std::allocator<T>{}.allocate(n);
+	}
+
+	void deallocate(T *p, std::size_t n) noexcept
+	{
+		counted_bytes -= n * sizeof(T);
+		std::allocator<T>{}.deallocate(p, n);
+	}
+
+	template<typename U>
+	bool operator==(const counting_allocator<U> &) const noexcept { return true; }
+};
+
+struct options
+{
+	std::size_t entries = 1 << 20;
+	std::size_t key_bytes = 8;
+	std::size_t value_bytes = 8;
+	std::uint64_t seed = 42;
+	bool json = false;
+};
+
+struct result
+{
+	std::string_view container;
+	std::string_view workload;
+	double ns_per_op;
+	double bytes_per_entry;
+};
+
+void report(const options &opts, const result &res)
+{
+	if(opts.json)
+		std::println(R"({{"container":"{}","workload":"{}","key_bytes":{},"value_bytes":{},"entries":{},"ns_per_op":{:.3f},"bytes_per_entry":{:.2f}}})",
+			res.container, res.workload, opts.key_bytes, opts.value_bytes, opts.entries, res.ns_per_op, res.bytes_per_entry);
+	else
+		std::println("{},{},{},{},{},{:.3f},{:.2f}",
+			res.container, res.workload, opts.key_bytes, opts.value_bytes, opts.entries, res.ns_per_op, res.bytes_per_entry);
+}
+
+template<typename Fn>
+double time_ns(std::size_t ops, Fn &&fn)
+{
+	auto begin = std::chrono::steady_clock::now();
+	fn();
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+	return elapsed.count() / static_cast<double>(ops ? ops : 1);
+}
+
+// keeps results alive so lookups aren't optimized out
+inline volatile std::uint64_t sink = 0;
+
+template<typename Key, typename Value>
+struct lazy_adapter
+{
+	static constexpr std::string_view name = "lazy_flat_table";
+	lazy_flat_table<Key, Value, blob_hash<sizeof(Key)>> table;
+
+	void reserve(std::size_t n) { table.reserve(n); }
+	void insert(const Key &key, const Value &value) { table.emplace(key, value); }
+	bool contains(const Key &key) const { return table.contains(key); }
+	void erase(const Key &key) { table.lazy_remove(key); }
+	void compact() { table.compact(); }
+	void force_compact() { table.force_compact(); }
+	std::size_t size() const { return table.size(); }
+	std::size_t bytes() const { return table.allocated_bytes(); }
+
+	std::uint64_t iterate()
+	{
+		std::uint64_t sum = 0;
+		for(auto &entry : table)
+			sum += entry.value().words[0];
+		return sum;
+	}
+};
+
+template<typename Key, typename Value>
+struct unordered_adapter
+{
+	static constexpr std::string_view name = "std::unordered_map";
+	std::unordered_map<Key, Value, blob_hash<sizeof(Key)>, std::equal_to<Key>, counting_allocator<std::pair<const Key, Value>>> table;
+
+	void reserve(std::size_t n) { table.reserve(n); }
+	void insert(const Key &key, const Value &value) { table.emplace(key, value); }
+	bool contains(const Key &key) const { return table.contains(key); }
+	void erase(const Key &key) { table.erase(key); }
+	void compact() {}
+	void force_compact() {}
+	std::size_t size() const { return table.size(); }
+	std::size_t bytes() const { return counted_bytes; }
+
+	std::uint64_t iterate()
+	{
+		std::uint64_t sum = 0;
+		for(auto &[key, value] : table)
+			sum += value.words[0];
+		return sum;
+	}
+};
+
+template<typename Adapter, typename Key, typename Value>
+void run_suite(const options &opts)
+{
+	std::mt19937_64 random(opts.seed);
+	std::vector<std::uint64_t> ids(opts.entries);
+	std::iota(ids.begin(), ids.end(), 0);
+	std::vector<std::uint64_t> shuffled = ids;
+	std::shuffle(shuffled.begin(), shuffled.end(), random);
+	std::string_view name = Adapter::name;
+	Value value(1);
+
+	{
+		Adapter adapter;
+		double ns = time_ns(opts.entries, [&]() {
+			for(std::uint64_t id : ids)
+				adapter.insert(Key(id), value);
+		});
+		report(opts, {name, "insert_sequential", ns, static_cast<double>(adapter.bytes()) / adapter.size()});
+	}
+
+	// destroyed before the iterate rows, std::unordered_map bytes are counted globally
+	{
+		Adapter adapter;
+		{
+			double ns = time_ns(opts.entries, [&]() {
+				for(std::uint64_t id : shuffled)
+					adapter.insert(Key(id), value);
+			});
+			report(opts, {name, "insert_random", ns, static_cast<double>(adapter.bytes()) / adapter.size()});
+		}
+
+		{
+			std::uint64_t found = 0;
+			double ns = time_ns(opts.entries, [&]() {
+				for(std::uint64_t id : shuffled)
+					found += adapter.contains(Key(id));
+			});
+			sink = sink + found;
+			report(opts, {name, "lookup_hit", ns, 0});
+		}
+
+		{
+			std::uint64_t found = 0;
+			double ns = time_ns(opts.entries, [&]() {
+				for(std::uint64_t id : shuffled)
+					found += adapter.contains(Key(id + opts.entries));
+			});
+			sink = sink + found;
+			report(opts, {name, "lookup_miss", ns, 0});
+		}
+
+		{
+			// every cycle removes then re-emplaces a window, compacting as it goes
+			std::size_t window = std::max<std::size_t>(opts.entries / 16, 1);
+			std::size_t ops = 0;
+			double ns = time_ns(0, [&]() {
+				for(std::size_t begin = 0; begin + window <= opts.entries; begin += window)
+				{
+					for(std::size_t i = begin; i < begin + window; ++i)
+						adapter.erase(Key(shuffled[i]));
+					adapter.compact();
+					for(std::size_t i = begin; i < begin + window; ++i)
+						adapter.insert(Key(shuffled[i]), value);
+					ops += 2 * window;
+				}
+			}) / static_cast<double>(ops ? ops : 1);
+			report(opts, {name, "churn_compact", ns, static_cast<double>(adapter.bytes()) / adapter.size()});
+		}
+
+		{
+			std::size_t half = opts.entries / 2;
+			for(std::size_t i = 0; i < half; ++i)
+				adapter.erase(Key(shuffled[i]));
+			double ns = time_ns(adapter.size(), [&]() { adapter.force_compact(); });
+			report(opts, {name, "force_compact", ns, static_cast<double>(adapter.bytes()) / adapter.size()});
+			for(std::size_t i = 0; i < half; ++i)
+				adapter.insert(Key(shuffled[i]), value);
+		}
+	}
+
+	for(std::size_t percent : {0, 25, 50, 75, 90})
+	{
+		Adapter sparse;
+		for(std::uint64_t id : ids)
+			sparse.insert(Key(id), value);
+		std::size_t removed = opts.entries * percent / 100;
+		for(std::size_t i = 0; i < removed; ++i)
+			sparse.erase(Key(shuffled[i]));
+
+		std::uint64_t sum = 0;
+		double ns = time_ns(sparse.size(), [&]() { sum = sparse.iterate(); });
+		sink = sink + sum;
+		std::string workload = "iterate_" + std::to_string(percent) + "pct_removed";
+		report(opts, {name, workload, ns, static_cast<double>(sparse.bytes()) / sparse.size()});
+	}
+}
+
+template<std::size_t KeyBytes, std::size_t ValueBytes>
+void run_sizes(const options &opts)
+{
+	using Key = blob<KeyBytes>;
+	using Value = blob<ValueBytes>;
+	run_suite<lazy_adapter<Key, Value>, Key, Value>(opts);
+	counted_bytes = 0;
+	run_suite<unordered_adapter<Key, Value>, Key, Value>(opts);
+}
+
+template<std::size_t KeyBytes>
+bool dispatch_value(const options &opts)
+{
+	switch(opts.value_bytes)
+	{
+	case 8: run_sizes<KeyBytes, 8>(opts); return true;
+	case 32: run_sizes<KeyBytes, 32>(opts); return true;
+	case 128: run_sizes<KeyBytes, 128>(opts); return true;
+	default: return false;
+	}
+}
+
+bool dispatch(const options &opts)
+{
+	switch(opts.key_bytes)
+	{
+	case 8: return dispatch_value<8>(opts);
+	case 16: return dispatch_value<16>(opts);
+	case 32: return dispatch_value<32>(opts);
+	default: return false;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	options opts;
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string_view arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if(arg == "--json")
+			opts.json = true;
+		else if(arg == "--entries" && has_value)
+			opts.entries = std::strtoull(argv[++i], nullptr, 10);
+		else if(arg == "--key-bytes" && has_value)
+			opts.key_bytes = std::strtoull(argv[++i], nullptr, 10);
+		else if(arg == "--value-bytes" && has_value)
+			opts.value_bytes = std::strtoull(argv[++i], nullptr, 10);
+		else if(arg == "--seed" && has_value)
+			opts.seed = std::strtoull(argv[++i], nullptr, 10);
+		else
+		{
+			std::println(stderr, "usage: {} [--entries N] [--key-bytes 8|16|32] [--value-bytes 8|32|128] [--seed S] [--json]", argv[0]);
+			return 1;
+		}
+	}
+
+	// per-entry results divide by the table size
+	if(opts.entries == 0)
+	{
+		std::println(stderr, "--entries must be greater than 0");
+		return 1;
+	}
+
+	if(!opts.json)
+		std::println("container,workload,key_bytes,value_bytes,entries,ns_per_op,bytes_per_entry");
+	if(!dispatch(opts))
+	{
+		std::println(stderr, "unsupported key/value size");
+		return 1;
+	}
+}
@@ -0,0 +1,89 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <print>
+#include <vector>
+#include "sugar_lazytable_snapshot.h"
+
+using namespace libsugarx;
+
+/*
+corrupted snapshot images must be refused by load_snapshot,
+leaving the target table as it was.
+*/
+
+using table = lazy_flat_table<std::uint64_t, std::uint64_t>;
+
+std::vector<char> read_file(const std::filesystem::path &path)
+{
+	std::ifstream in(path, std::ios::binary);
+	return std::vector<char>(std::istreambuf_iterator<char>(in), {});
+}
+
+void write_file(const std::filesystem::path &path, const std::vector<char> &image)
+{
+	std::ofstream out(path, std::ios::binary);
+	out.write(image.data(), static_cast<std::streamsize>(image.size()));
+}
+
+void set_slot(std::vector<char> &image, const lazy_snapshot_header &header, std::size_t pos, std::uint64_t slot)
+{
+	slot = to_little_endian(slot);
+	std::memcpy(image.data() + header.slots_offset + pos * sizeof(slot), &slot, sizeof(slot));
+}
+
+// the target keeps its single entry when the image is refused
+void expect_refused(const std::filesystem::path &path, const std::vector<char> &image)
+{
+	write_file(path, image);
+	table target;
+	target.emplace(7, 7);
+	assert(load_snapshot(path, target) == snapshot_error::corrupt_index);
+	assert(target.size() == 1 && target.at(7).value() == 7);
+}
+
+int main(int argc, char **argv)
+{
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "libsugarx_snapshot_test.bin";
+	table source;
+	for(std::uint64_t i = 0; i < 100; ++i)
+		source.emplace(i, i * 3);
+	assert(write_snapshot(source, path) == snapshot_error::none);
+
+	table loaded;
+	assert(load_snapshot(path, loaded) == snapshot_error::none);
+	assert(loaded.size() == 100 && loaded.at(42).value() == 126);
+
+	std::vector<char> image = read_file(path);
+	lazy_snapshot_header header;
+	assert(header.decode(const_data_span(reinterpret_cast<const std::byte *>(image.data()), image.size())) == snapshot_error::none);
+
+	// the first two full positions of the index
+	std::vector<std::size_t> full;
+	for(std::size_t pos = 0; pos < header.capacity && full.size() < 2; ++pos)
+	{
+		if(!(static_cast<std::uint8_t>(image[header.controls_offset + pos]) & 0x80))
+			full.push_back(pos);
+	}
+	assert(full.size() == 2);
+
+	std::vector<char> corrupt = image;
+	set_slot(corrupt, header, full[0], 1000000);
+	expect_refused(path, corrupt);
+
+	corrupt = image;
+	corrupt[header.controls_offset + full[0]] = static_cast<char>(0x80);
+	expect_refused(path, corrupt);
+
+	// two positions on slot 0 leave another entry unreachable
+	corrupt = image;
+	set_slot(corrupt, header, full[0], 0);
+	set_slot(corrupt, header, full[1], 0);
+	expect_refused(path, corrupt);
+
+	std::filesystem::remove(path);
+	std::println("snapshot corruption checks passed");
+}
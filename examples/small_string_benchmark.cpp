@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+#include "sugar_string.h"
+
+using namespace libsugarx;
+
+/*
+builds strings with lengths drawn from a field-like distribution
+(most 4..20 chars, some up to 60, a few up to 300)
+with std::string and small_string<N>, counting heap allocations.
+prints CSV.
+*/
+
+constexpr std::size_t StringCount = 1 << 20;
+
+inline std::size_t allocation_count = 0;
+
+void *operator new(std::size_t size)
+{
+	++allocation_count;
+	if(void *p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+std::vector<std::size_t> make_lengths()
+{
+	std::mt19937_64 random(7);
+	std::vector<std::size_t> lengths(StringCount);
+	for(std::size_t &length : lengths)
+	{
+		std::uint64_t bucket = random() % 100;
+		if(bucket < 80)
+			length = 4 + random() % 17;
+		else if(bucket < 95)
+			length = 21 + random() % 40;
+		else
+			length = 61 + random() % 240;
+	}
+	return lengths;
+}
+
+template<typename String>
+void run(std::string_view name, const std::vector<std::size_t> &lengths)
+{
+	std::vector<String> strings;
+	strings.reserve(lengths.size());
+
+	std::size_t before = allocation_count;
+	auto begin = std::chrono::steady_clock::now();
+	for(std::size_t i = 0; i < lengths.size(); ++i)
+	{
+		String str;
+		for(std::size_t c = 0; c < lengths[i]; ++c)
+		{
+			if constexpr(requires { str.concat('a'); })
+				str.concat(static_cast<char>('a' + c % 26));
+			else
+				str.push_back(static_cast<char>('a' + c % 26));
+		}
+		strings.push_back(std::move(str));
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+	std::size_t allocations = allocation_count - before;
+	std::println("{},{},{},{:.3f},{:.2f}", name, sizeof(String), allocations, static_cast<double>(allocations) / lengths.size(), elapsed.count());
+}
+
+int main(int argc, char **argv)
+{
+	std::vector<std::size_t> lengths = make_lengths();
+	std::println("type,sizeof,allocations,allocations_per_string,ms");
+	run<std::string>("std::string", lengths);
+	run<small_string<24>>("small_string<24>", lengths);
+	run<small_string<32>>("small_string<32>", lengths);
+	run<small_string<64>>("small_string<64>", lengths);
+}
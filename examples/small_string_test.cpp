@@ -0,0 +1,47 @@
+#include <cassert>
+#include <print>
+#include <string>
+#include "sugar_string.h"
+
+using namespace libsugarx;
+
+/*
+small_string fed views of its own contents, inline and spilled.
+build with -fsanitize=address to catch reads of a released buffer.
+*/
+
+int main(int argc, char **argv)
+{
+	small_string<16> str("0123456789abcdefghij");
+	std::string expected(str.view());
+	assert(!str.is_inline());
+
+	// self-append until the heap buffer has to grow
+	for(int i = 0; i < 6; ++i)
+	{
+		str.concat(str.view());
+		expected += expected;
+		assert(str.view() == expected);
+	}
+
+	str.concat(str[3]);
+	expected += expected[3];
+	assert(str.view() == expected);
+
+	// assign an overlapping substring of itself
+	str = str.view().substr(5, 100);
+	expected = expected.substr(5, 100);
+	assert(str.view() == expected);
+
+	small_string<16> grown("abcdefghijklmnopqrstuvwxyz");
+	std::size_t capacity = grown.capacity();
+	grown.concat(grown.view().substr(1, capacity));
+	std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+	assert(grown.view() == alphabet + alphabet.substr(1, capacity));
+
+	small_string<16> spill("0123456789");
+	spill.concat(spill.view());
+	assert(spill.view() == "01234567890123456789");
+
+	std::println("small_string aliasing checks passed");
+}
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdint>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "sugar_lazytable.h"
+#include "sugar_string.h"
+
+using namespace libsugarx;
+
+/*
+throughput of wide_string_hash against the FNV-1a sugarx_string_hash
+and std::hash<std::string_view> over several key lengths,
+then lookups in a lazy_flat_table<std::string, ...> with each hasher.
+prints CSV.
+*/
+
+constexpr std::size_t BytesPerRun = 1 << 26;
+
+// keeps results alive so hashing isn't optimized out
+inline volatile std::uint64_t sink = 0;
+
+std::vector<std::string> make_keys(std::size_t count, std::size_t length)
+{
+	std::mt19937_64 random(length);
+	std::vector<std::string> keys(count, std::string(length, '\0'));
+	for(std::string &key : keys)
+		for(char &c : key)
+			c = static_cast<char>('a' + random() % 26);
+	return keys;
+}
+
+template<typename Fn>
+double gib_per_second(const std::vector<std::string> &keys, Fn &&fn)
+{
+	std::size_t rounds = std::max<std::size_t>(BytesPerRun / (keys.size() * std::max<std::size_t>(keys[0].size(), 1)), 1);
+	std::uint64_t sum = 0;
+	auto begin = std::chrono::steady_clock::now();
+	for(std::size_t round = 0; round < rounds; ++round)
+		for(const std::string &key : keys)
+			sum += fn(std::string_view(key));
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+	sink = sink + sum;
+	return static_cast<double>(rounds * keys.size() * keys[0].size()) / elapsed.count() / (1 << 30);
+}
+
+template<typename Hash>
+double lookup_mops(const std::vector<std::string> &keys)
+{
+	lazy_flat_table<std::string, std::uint32_t, Hash> table;
+	table.reserve(keys.size());
+	for(std::uint32_t i = 0; i < keys.size(); ++i)
+		table.emplace(keys[i], i);
+
+	std::uint64_t found = 0;
+	auto begin = std::chrono::steady_clock::now();
+	for(const std::string &key : keys)
+		found += table.contains(key);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+	sink = sink + found;
+	return static_cast<double>(keys.size()) / elapsed.count() / 1e6;
+}
+
+struct fnv_hash
+{
+	std::size_t operator()(std::string_view str) const noexcept { return sugarx_string_hash{}(str).v; }
+};
+
+int main(int argc, char **argv)
+{
+	std::println("length,fnv_gibs,std_gibs,wide_gibs,fnv_lookup_mops,std_lookup_mops,wide_lookup_mops");
+	for(std::size_t length : {4, 8, 16, 32, 64, 128, 256, 1024, 4096})
+	{
+		std::vector<std::string> keys = make_keys(std::max<std::size_t>((1 << 20) / length, 1024), length);
+		double fnv = gib_per_second(keys, [](std::string_view str) { return sugarx_string_hash{}(str).v; });
+		double standard = gib_per_second(keys, [](std::string_view str) { return std::hash<std::string_view>{}(str); });
+		double wide = gib_per_second(keys, [](std::string_view str) { return wide_string_hash{}(str); });
+		std::println("{},{:.3f},{:.3f},{:.3f},{:.2f},{:.2f},{:.2f}", length, fnv, standard, wide,
+			lookup_mops<fnv_hash>(keys), lookup_mops<std::hash<std::string>>(keys), lookup_mops<wide_string_hash>(keys));
+	}
+}
@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cstdint>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "sugar_string.h"
+
+using namespace libsugarx;
+
+/*
+string_search and string_split against std::string_view on generated log and CSV lines.
+prints CSV: workload, line width, MB/s for std and for libsugarx.
+*/
+
+constexpr std::size_t BytesPerRun = 1 << 27;
+
+// keeps results alive so scans aren't optimized out
+inline volatile std::uint64_t sink = 0;
+
+std::vector<std::string> make_lines(std::size_t width, char delimiter, std::size_t field_width)
+{
+	std::mt19937_64 random(width);
+	std::vector<std::string> lines(std::max<std::size_t>((1 << 22) / width, 64));
+	for(std::string &line : lines)
+	{
+		while(line.size() < width)
+		{
+			std::size_t field = 1 + random() % (2 * field_width);
+			for(std::size_t i = 0; i < field && line.size() < width; ++i)
+				line.push_back(static_cast<char>('a' + random() % 26));
+			line.push_back(delimiter);
+		}
+		line.resize(width);
+		line.back() = '\n';
+	}
+	return lines;
+}
+
+template<typename Fn>
+double mb_per_second(const std::vector<std::string> &lines, Fn &&fn)
+{
+	std::size_t rounds = std::max<std::size_t>(BytesPerRun / (lines.size() * lines[0].size()), 1);
+	std::uint64_t sum = 0;
+	auto begin = std::chrono::steady_clock::now();
+	for(std::size_t round = 0; round < rounds; ++round)
+		for(const std::string &line : lines)
+			sum += fn(std::string_view(line));
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+	sink = sink + sum;
+	return static_cast<double>(rounds * lines.size() * lines[0].size()) / elapsed.count() / 1e6;
+}
+
+std::size_t std_split_count(std::string_view line, std::string_view delimiters)
+{
+	std::size_t fields = 1;
+	for(std::size_t pos = line.find_first_of(delimiters); pos != std::string_view::npos; pos = line.find_first_of(delimiters, pos + 1))
+		++fields;
+	return fields;
+}
+
+void report(std::string_view workload, std::size_t width, double standard, double sugarx)
+{
+	std::println("{},{},{:.1f},{:.1f}", workload, width, standard, sugarx);
+}
+
+int main(int argc, char **argv)
+{
+	std::println("workload,width,std_mbs,sugarx_mbs");
+	for(std::size_t width : {80, 200, 1000, 4000})
+	{
+		std::vector<std::string> csv = make_lines(width, ',', 8);
+		std::vector<std::string> log = make_lines(width, ' ', 12);
+
+		report("find_char", width,
+			mb_per_second(log, [](std::string_view line) { return line.find('\n'); }),
+			mb_per_second(log, [](std::string_view line) { return string_search::find(line, '\n'); }));
+		report("find_substring", width,
+			mb_per_second(log, [](std::string_view line) { return line.find("error"); }),
+			mb_per_second(log, [](std::string_view line) { return string_search::find(line, "error"); }));
+		report("find_first_of", width,
+			mb_per_second(log, [](std::string_view line) { return line.find_first_of("=:\"\n"); }),
+			mb_per_second(log, [](std::string_view line) { return string_search::find_first_of(line, "=:\"\n"); }));
+		report("split_csv", width,
+			mb_per_second(csv, [](std::string_view line) { return std_split_count(line, ","); }),
+			mb_per_second(csv, [](std::string_view line) {
+				std::size_t fields = 0;
+				for([[maybe_unused]] std::string_view field : string_split(line, ","))
+					++fields;
+				return fields;
+			}));
+		report("split_log", width,
+			mb_per_second(log, [](std::string_view line) { return std_split_count(line, " \t"); }),
+			mb_per_second(log, [](std::string_view line) {
+				std::size_t fields = 0;
+				for([[maybe_unused]] std::string_view field : string_split(line, " \t"))
+					++fields;
+				return fields;
+			}));
+	}
+}
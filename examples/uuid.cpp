@@ -1,6 +1,6 @@
 #include <print>
 #include "sugar_string.h"
-#define LIBSUGARX_UUID_IMPLEMENTATION
+#define LIBSUGARX_UUID_GENERATION_IMPL
 #include "sugar_uuid.h"
 
 using namespace libsugarx;
@@ -18,4 +18,8 @@ int main(int argc, char **argv)
 	std::println("UUID name is '{}'", aName);
 	std::println("Namespace is '{}'. That was what we have generated.", Uuidv7.to_string());
 	std::println("{} {}", uuid::generate_v3(aName, Uuidv7).to_string(), uuid::generate_v5(aName, Uuidv7).to_string());
+	std::println("Name-based UUIDs even work at compile time.");
+	constexpr uuid ExampleDns = uuid::generate_v5("www.example.com", uuid_namespace_dns);
+	static_assert(ExampleDns.to_string().view() == "2ed6657d-e927-568b-95e1-2665a8aea6a2");
+	std::println("v5 of www.example.com in the DNS namespace is {}", ExampleDns.to_string());
 }
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <print>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "sugar_string.h"
+#define LIBSUGARX_UUID_GENERATION_IMPL
+#include "sugar_uuid.h"
+
+using namespace libsugarx;
+
+/*
+UUID generation rate at 1..hardware_concurrency threads:
+one RAND_bytes call per UUID (the old path) against the per-thread uuid_generator,
+one at a time and in batches.
+prints CSV: mode, threads, million UUIDs per second.
+*/
+
+constexpr std::size_t UuidsPerThread = 1 << 20;
+constexpr std::size_t BatchSize = 256;
+
+// keeps results alive so generation isn't optimized out
+inline std::atomic<std::uint64_t> sink = 0;
+
+std::uint64_t first_word(const uuid &id)
+{
+	std::uint64_t word;
+	std::memcpy(&word, id.raw_data().data(), sizeof(word));
+	return word;
+}
+
+void rand_bytes_v4()
+{
+	std::uint64_t sum = 0;
+	for(std::size_t i = 0; i < UuidsPerThread; ++i)
+	{
+		uuid id;
+		RAND_bytes(reinterpret_cast<unsigned char *>(id.raw_data().data()), static_cast<int>(id.raw_data().size()));
+		sum += first_word(id);
+	}
+	sink += sum;
+}
+
+template<bool V7>
+void single()
+{
+	std::uint64_t sum = 0;
+	for(std::size_t i = 0; i < UuidsPerThread; ++i)
+		sum += first_word(V7 ? uuid::generate_v7_nullable() : uuid::generate_v4_nullable());
+	sink += sum;
+}
+
+template<bool V7>
+void batch()
+{
+	std::vector<uuid> ids(BatchSize);
+	std::uint64_t sum = 0;
+	for(std::size_t i = 0; i < UuidsPerThread; i += BatchSize)
+	{
+		if constexpr(V7)
+			uuid::generate_v7_batch(ids);
+		else
+			uuid::generate_v4_batch(ids);
+		sum += first_word(ids[0]);
+	}
+	sink += sum;
+}
+
+void run(std::string_view mode, unsigned threads, void (*work)())
+{
+	auto begin = std::chrono::steady_clock::now();
+	{
+		std::vector<std::jthread> workers;
+		for(unsigned i = 0; i < threads; ++i)
+			workers.emplace_back(work);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+	std::println("{},{},{:.2f}", mode, threads, static_cast<double>(UuidsPerThread * threads) / elapsed.count() / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+	std::println("mode,threads,million_uuids_per_second");
+	unsigned max_threads = std::max(std::thread::hardware_concurrency(), 1U);
+	for(unsigned threads = 1; threads <= max_threads; threads *= 2)
+	{
+		run("rand_bytes_v4", threads, rand_bytes_v4);
+		run("generator_v4", threads, single<false>);
+		run("batch_v4", threads, batch<false>);
+		run("generator_v7", threads, single<true>);
+		run("batch_v7", threads, batch<true>);
+	}
+}
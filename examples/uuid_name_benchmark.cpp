@@ -0,0 +1,59 @@
+#include <chrono>
+#include <cstdint>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "sugar_string.h"
+#define LIBSUGARX_UUID_GENERATION_IMPL
+#include "sugar_uuid.h"
+
+using namespace libsugarx;
+
+/*
+million name-based UUIDs per second under one namespace:
+uuid::generate_v3/v5 per name against a uuid_name_generator, one name at a time and as a batch
+(batches of uuid_name_generator::parallel_batch or more run on all cores).
+prints CSV.
+*/
+
+constexpr std::size_t NameCount = 1 << 20;
+
+// keeps results alive so hashing isn't optimized out
+inline volatile std::uint64_t sink = 0;
+
+template<typename Fn>
+double mups(std::size_t count, Fn &&fn)
+{
+	auto begin = std::chrono::steady_clock::now();
+	fn();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+	return static_cast<double>(count) / elapsed.count() / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+	uuid name_space(uuid_string("6ba7b811-9dad-11d1-80b4-00c04fd430c8"));
+	std::vector<std::string> storage(NameCount);
+	for(std::size_t i = 0; i < storage.size(); ++i)
+		storage[i] = "https://example.com/items/" + std::to_string(i);
+	std::vector<std::string_view> names(storage.begin(), storage.end());
+	std::vector<uuid> out(names.size());
+
+	std::println("version,per_call_mups,generator_mups,batch_mups");
+	for(int version : {3, 5})
+	{
+		uuid_name_generator generator(name_space, version);
+		double per_call = mups(names.size(), [&] {
+			for(std::size_t i = 0; i < names.size(); ++i)
+				out[i] = version == 3 ? uuid::generate_v3(names[i], name_space) : uuid::generate_v5(names[i], name_space);
+		});
+		double single = mups(names.size(), [&] {
+			for(std::size_t i = 0; i < names.size(); ++i)
+				out[i] = generator.generate(names[i]);
+		});
+		double batch = mups(names.size(), [&] { generator.generate(names, out); });
+		sink = sink + static_cast<unsigned char>(out.back().raw_data()[0]);
+		std::println("{},{:.2f},{:.2f},{:.2f}", version, per_call, single, batch);
+	}
+}
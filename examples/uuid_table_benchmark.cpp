@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <print>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "sugar_uuid_table.h"
+
+using namespace libsugarx;
+
+/*
+million operations per second on random v4-like and v7-like keys:
+hashing and sorting with the previous string_view hash and byte compare against uuid_hash and uuid <=>,
+and a hash join (build, probe with half misses) with std::unordered_set/map against uuid_set/uuid_map.
+prints CSV.
+*/
+
+constexpr std::size_t UuidCount = 1 << 20;
+
+// keeps results alive so lookups aren't optimized out
+inline volatile std::uint64_t sink = 0;
+
+struct old_hash
+{
+	std::size_t operator()(const uuid &id) const noexcept
+	{
+		return std::hash<std::string_view>{}({reinterpret_cast<const char *>(id.raw_data().data()), id.raw_data().size()});
+	}
+};
+
+bool old_less(const uuid &a, const uuid &b)
+{
+	return a.raw_data() < b.raw_data();
+}
+
+std::vector<uuid> make_ids(bool time_ordered, std::uint64_t seed)
+{
+	std::mt19937_64 random(seed);
+	std::vector<uuid> ids(UuidCount);
+	for(std::size_t i = 0; i < ids.size(); ++i)
+	{
+		for(std::byte &b : ids[i].raw_data())
+			b = static_cast<std::byte>(random());
+		if(time_ordered)
+		{
+			// shared millisecond prefix with a counter, like a burst of v7 ids
+			std::uint64_t prefix = (0x0190000000000000ULL + seed) + (i << 4);
+			for(std::size_t b = 0; b < 8; ++b)
+				ids[i].raw_data()[b] = static_cast<std::byte>(prefix >> (56 - 8 * b));
+		}
+	}
+	return ids;
+}
+
+template<typename Fn>
+double mops(Fn &&fn)
+{
+	auto begin = std::chrono::steady_clock::now();
+	std::uint64_t sum = fn();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+	sink = sink + sum;
+	return static_cast<double>(UuidCount) / elapsed.count() / 1e6;
+}
+
+void run(std::string_view keys, const std::vector<uuid> &build, const std::vector<uuid> &probe)
+{
+	// each side is timed in its own statement, old first, so the run order doesn't depend on argument evaluation
+	double old_rate = mops([&] {
+		std::uint64_t sum = 0;
+		for(const uuid &id : build)
+			sum += old_hash{}(id);
+		return sum;
+	});
+	double new_rate = mops([&] {
+		std::uint64_t sum = 0;
+		for(const uuid &id : build)
+			sum += uuid_hash{}(id);
+		return sum;
+	});
+	std::println("{},hash,{:.2f},{:.2f}", keys, old_rate, new_rate);
+
+	std::vector<uuid> sorted = probe;
+	old_rate = mops([&] {
+		std::ranges::sort(sorted, old_less);
+		return sorted.size();
+	});
+	sorted = probe;
+	new_rate = mops([&] {
+		std::ranges::sort(sorted);
+		return sorted.size();
+	});
+	std::println("{},sort,{:.2f},{:.2f}", keys, old_rate, new_rate);
+
+	std::unordered_set<uuid, old_hash> std_set;
+	uuid_set set;
+	old_rate = mops([&] {
+		for(const uuid &id : build)
+			std_set.insert(id);
+		return std_set.size();
+	});
+	new_rate = mops([&] {
+		for(const uuid &id : build)
+			set.insert(id);
+		return set.size();
+	});
+	std::println("{},set_build,{:.2f},{:.2f}", keys, old_rate, new_rate);
+	old_rate = mops([&] {
+		std::uint64_t sum = 0;
+		for(const uuid &id : probe)
+			sum += std_set.contains(id);
+		return sum;
+	});
+	new_rate = mops([&] {
+		std::uint64_t sum = 0;
+		for(const uuid &id : probe)
+			sum += set.contains(id);
+		return sum;
+	});
+	std::println("{},set_probe,{:.2f},{:.2f}", keys, old_rate, new_rate);
+
+	std::unordered_map<uuid, std::uint64_t, old_hash> std_map;
+	uuid_map<std::uint64_t> map;
+	old_rate = mops([&] {
+		for(std::size_t i = 0; i < build.size(); ++i)
+			std_map.try_emplace(build[i], i);
+		return std_map.size();
+	});
+	new_rate = mops([&] {
+		for(std::size_t i = 0; i < build.size(); ++i)
+			map.try_emplace(build[i], i);
+		return map.size();
+	});
+	std::println("{},map_build,{:.2f},{:.2f}", keys, old_rate, new_rate);
+	old_rate = mops([&] {
+		std::uint64_t sum = 0;
+		for(const uuid &id : probe)
+		{
+			auto found = std_map.find(id);
+			if(found != std_map.end())
+				sum += found->second;
+		}
+		return sum;
+	});
+	new_rate = mops([&] {
+		std::uint64_t sum = 0;
+		for(const uuid &id : probe)
+		{
+			if(auto found = map.find(id))
+				sum += found->get();
+		}
+		return sum;
+	});
+	std::println("{},map_join,{:.2f},{:.2f}", keys, old_rate, new_rate);
+}
+
+int main(int argc, char **argv)
+{
+	std::println("keys,operation,old_mops,new_mops");
+	for(bool time_ordered : {false, true})
+	{
+		std::vector<uuid> build = make_ids(time_ordered, 1);
+		// half of the probes hit
+		std::vector<uuid> probe = make_ids(time_ordered, 2);
+		std::mt19937_64 random(3);
+		for(std::size_t i = 0; i < probe.size(); i += 2)
+			probe[i] = build[random() % build.size()];
+		run(time_ordered ? "v7" : "v4", build, probe);
+	}
+}
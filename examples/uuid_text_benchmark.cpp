@@ -0,0 +1,111 @@
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "sugar_uuid.h"
+
+using namespace libsugarx;
+
+/*
+million UUIDs per second for text conversion:
+the previous from_chars/string_append_byte code against uuid::from_string/to_string,
+and the bulk uuid_parse_many/uuid_format_many over a newline separated buffer.
+prints CSV.
+*/
+
+constexpr std::size_t UuidCount = 1 << 20;
+
+// keeps results alive so conversions aren't optimized out
+inline volatile std::uint64_t sink = 0;
+
+uuid_string old_to_string(const uuid &id)
+{
+	uuid_string str;
+	for(std::size_t i = 0; i < 16; ++i)
+	{
+		if(i == 4 || i == 6 || i == 8 || i == 10)
+			str.concat('-');
+		string_append_byte(str, id.raw_data()[i]);
+	}
+	return str;
+}
+
+bool old_from_string(std::string_view str, uuid &id)
+{
+	if(str.size() != 36 || str[8] != '-' || str[13] != '-' || str[18] != '-' || str[23] != '-')
+		return false;
+	std::array<char, 32> hex{};
+	std::size_t count = 0;
+	for(char c : str)
+	{
+		if(c != '-')
+			hex[count++] = c;
+	}
+	for(std::size_t i = 0; i < 16; ++i)
+	{
+		int value;
+		if(std::from_chars(&hex[i * 2], &hex[i * 2] + 2, value, 16).ec != std::errc{})
+			return false;
+		id.raw_data()[i] = static_cast<std::byte>(value);
+	}
+	return true;
+}
+
+template<typename Fn>
+double mups(Fn &&fn)
+{
+	auto begin = std::chrono::steady_clock::now();
+	std::uint64_t sum = fn();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+	sink = sink + sum;
+	return static_cast<double>(UuidCount) / elapsed.count() / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+	std::mt19937_64 random(22);
+	std::vector<uuid> ids(UuidCount);
+	for(uuid &id : ids)
+		for(std::byte &b : id.raw_data())
+			b = static_cast<std::byte>(random());
+
+	std::string text(37 * ids.size(), '\0');
+	text.resize(uuid_format_many(ids, text, '\n'));
+	std::vector<uuid> parsed(ids.size());
+	std::vector<uuid_error> errors(ids.size());
+
+	std::println("operation,old_mups,new_mups");
+	std::println("format,{:.2f},{:.2f}",
+		mups([&] {
+			std::uint64_t sum = 0;
+			for(const uuid &id : ids)
+				sum += static_cast<unsigned char>(old_to_string(id)[35]);
+			return sum;
+		}),
+		mups([&] {
+			std::uint64_t sum = 0;
+			for(const uuid &id : ids)
+				sum += static_cast<unsigned char>(id.to_string()[35]);
+			return sum;
+		}));
+	std::println("parse,{:.2f},{:.2f}",
+		mups([&] {
+			std::uint64_t sum = 0;
+			for(std::size_t i = 0; i < ids.size(); ++i)
+				sum += old_from_string(std::string_view(text).substr(37 * i, 36), parsed[i]);
+			return sum;
+		}),
+		mups([&] {
+			std::uint64_t sum = 0;
+			for(std::size_t i = 0; i < ids.size(); ++i)
+				sum += parsed[i].from_string(std::string_view(text).substr(37 * i, 36)) == uuid_error::none;
+			return sum;
+		}));
+	std::println("bulk_format,,{:.2f}", mups([&] { return uuid_format_many(ids, text, '\n'); }));
+	std::println("bulk_parse,,{:.2f}", mups([&] { return uuid_parse_many(text, parsed, errors).failed; }));
+}
@@ -0,0 +1,80 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <print>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "sugar_string.h"
+#define LIBSUGARX_UUID_GENERATION_IMPL
+#include "sugar_uuid.h"
+
+using namespace libsugarx;
+
+/*
+UUIDs per second from the shared uuid_v7_generator at 1..64 threads,
+one at a time and in batches, checking every thread sees strictly increasing UUIDs.
+lead_ms is how far the last timestamp ran ahead of the clock.
+prints CSV.
+*/
+
+constexpr std::size_t UuidsPerRun = 1 << 23;
+constexpr std::size_t BatchSize = 64;
+
+std::uint64_t timestamp_ms(const uuid &id)
+{
+	std::uint64_t ms = 0;
+	for(std::size_t i = 0; i < 6; ++i)
+		ms = (ms << 8) | static_cast<std::uint64_t>(id.raw_data()[i]);
+	return ms;
+}
+
+void run(std::string_view mode, unsigned threads, std::size_t batch)
+{
+	std::size_t per_thread = UuidsPerRun / threads;
+	std::atomic<std::size_t> unordered = 0;
+	std::atomic<std::uint64_t> last_ms = 0;
+
+	auto begin = std::chrono::steady_clock::now();
+	{
+		std::vector<std::jthread> workers;
+		for(unsigned t = 0; t < threads; ++t)
+		{
+			workers.emplace_back([&] {
+				std::vector<uuid> ids(batch);
+				uuid previous;
+				std::size_t local_unordered = 0;
+				for(std::size_t i = 0; i < per_thread; i += batch)
+				{
+					if(batch == 1)
+						ids[0] = uuid::generate_v7_nullable();
+					else
+						uuid::generate_v7_batch(ids);
+					for(const uuid &id : ids)
+					{
+						local_unordered += !(previous < id);
+						previous = id;
+					}
+				}
+				unordered += local_unordered;
+				std::uint64_t ms = timestamp_ms(previous);
+				for(std::uint64_t seen = last_ms.load(); ms > seen && !last_ms.compare_exchange_weak(seen, ms);)
+					;
+			});
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+	std::int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	std::println("{},{},{:.2f},{},{}", mode, threads, static_cast<double>(per_thread * threads) / elapsed.count() / 1e6,
+		unordered.load(), static_cast<std::int64_t>(last_ms.load()) - now_ms);
+}
+
+int main(int argc, char **argv)
+{
+	std::println("mode,threads,million_uuids_per_second,unordered,lead_ms");
+	for(unsigned threads = 1; threads <= 64; threads *= 2)
+	{
+		run("single", threads, 1);
+		run("batch", threads, BatchSize);
+	}
+}
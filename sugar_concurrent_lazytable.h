@@ -0,0 +1,286 @@
+#ifndef LIBSUGARX_CONCURRENT_LAZYTABLE_H
+#define LIBSUGARX_CONCURRENT_LAZYTABLE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "sugar_lazytable.h"
+
+namespace libsugarx
+{
+	/*
+	class concurrent_lazy_flat_table
+	keys are partitioned over Shards lazy_flat_tables, each behind its own shared_mutex,
+	so lookups on different shards never contend and lookups on one shard share the lock.
+	emplace/lazy_remove/compact keep the lazy_flat_table semantics inside each shard.
+	references never leave a lock, use find/visit to reach values.
+	*/
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, std::size_t Shards = 16>
+	class concurrent_lazy_flat_table
+	{
+		static_assert(std::has_single_bit(Shards), "Shards must be a power of two.");
+
+	public:
+		using table = lazy_flat_table<Key, Value, Hash, KeyEqual>;
+		using proxy = typename table::proxy;
+
+		concurrent_lazy_flat_table() = default;
+
+		concurrent_lazy_flat_table(const concurrent_lazy_flat_table &other) = delete;
+		concurrent_lazy_flat_table &operator=(const concurrent_lazy_flat_table &other) = delete;
+
+		template<typename... Args>
+		/*
+		returns false if key is already in use.
+		*/
+		bool emplace(Key key, Args &&...args)
+		{
+			shard &target = shard_of(key);
+			std::unique_lock lock(target.mutex);
+			return target.entries.try_emplace(std::move(key), std::forward<Args>(args)...).second;
+		}
+
+		template<typename K = Key>
+		requires std::convertible_to<const K &, const Key &> || lazy_transparent_lookup<Hash, KeyEqual>
+		bool contains(const K &key) const
+		{
+			const shard &target = shard_of(key);
+			std::shared_lock lock(target.mutex);
+			return target.entries.contains(key);
+		}
+
+		template<typename K = Key>
+		requires std::convertible_to<const K &, const Key &> || lazy_transparent_lookup<Hash, KeyEqual>
+		/*
+		returns a copy of the value, throws std::out_of_range like lazy_flat_table::at.
+		*/
+		Value at(const K &key) const
+		{
+			const shard &target = shard_of(key);
+			std::shared_lock lock(target.mutex);
+			return target.entries.at(key).value();
+		}
+
+		template<typename K = Key>
+		requires std::convertible_to<const K &, const Key &> || lazy_transparent_lookup<Hash, KeyEqual>
+		std::optional<Value> find(const K &key) const
+		{
+			const shard &target = shard_of(key);
+			std::shared_lock lock(target.mutex);
+			const proxy *found = target.entries.find(key);
+			if(!found)
+				return std::nullopt;
+			return found->value();
+		}
+
+		template<typename K = Key, typename Fn>
+		requires std::convertible_to<const K &, const Key &> || lazy_transparent_lookup<Hash, KeyEqual>
+		/*
+		fn(proxy &) under the shard's exclusive lock.
+		returns false if key doesn't exist.
+		*/
+		bool visit(const K &key, Fn &&fn)
+		{
+			shard &target = shard_of(key);
+			std::unique_lock lock(target.mutex);
+			proxy *found = target.entries.find(key);
+			if(!found)
+				return false;
+			fn(*found);
+			return true;
+		}
+
+		template<typename K = Key, typename Fn>
+		requires std::convertible_to<const K &, const Key &> || lazy_transparent_lookup<Hash, KeyEqual>
+		/*
+		fn(const proxy &) under the shard's shared lock.
+		*/
+		bool cvisit(const K &key, Fn &&fn) const
+		{
+			const shard &target = shard_of(key);
+			std::shared_lock lock(target.mutex);
+			const proxy *found = target.entries.find(key);
+			if(!found)
+				return false;
+			fn(*found);
+			return true;
+		}
+
+		template<typename K = Key>
+		requires std::convertible_to<const K &, const Key &> || lazy_transparent_lookup<Hash, KeyEqual>
+		/*
+		returns true as the variable exists
+		*/
+		bool lazy_remove(const K &key)
+		{
+			shard &target = shard_of(key);
+			std::unique_lock lock(target.mutex);
+			return target.entries.lazy_remove(key);
+		}
+
+		template<typename K = Key>
+		requires std::convertible_to<const K &, const Key &> || lazy_transparent_lookup<Hash, KeyEqual>
+		/*
+		compacts only the shard owning key.
+		*/
+		void remove(const K &key)
+		{
+			shard &target = shard_of(key);
+			std::unique_lock lock(target.mutex);
+			target.entries.remove(key);
+		}
+
+		/*
+		shards are compacted one after another,
+		so only one shard is blocked at a time.
+		*/
+		void compact()
+		{
+			for(shard &target : shards_)
+			{
+				std::unique_lock lock(target.mutex);
+				target.entries.compact();
+			}
+		}
+
+		void force_compact()
+		{
+			for(shard &target : shards_)
+			{
+				std::unique_lock lock(target.mutex);
+				target.entries.force_compact();
+			}
+		}
+
+		/*
+		spreads size evenly over the shards.
+		*/
+		void reserve(std::size_t size)
+		{
+			for(shard &target : shards_)
+			{
+				std::unique_lock lock(target.mutex);
+				target.entries.reserve(size / Shards + 1);
+			}
+		}
+
+		void clear()
+		{
+			for(shard &target : shards_)
+			{
+				std::unique_lock lock(target.mutex);
+				target.entries.clear();
+			}
+		}
+
+		/*
+		sum of the shard sizes, each read under its own lock,
+		may be stale while other threads are writing.
+		*/
+		std::size_t size() const
+		{
+			std::size_t result = 0;
+			for(const shard &target : shards_)
+			{
+				std::shared_lock lock(target.mutex);
+				result += target.entries.size();
+			}
+			return result;
+		}
+
+		bool empty() const
+		{
+			return size() == 0;
+		}
+
+		static constexpr std::size_t shard_count() noexcept { return Shards; }
+
+		/*
+		fn(const proxy &) for every live entry.
+		each shard is a consistent snapshot, shards are visited one after another.
+		*/
+		template<typename Fn>
+		void for_each(Fn &&fn) const
+		{
+			for(const shard &target : shards_)
+			{
+				std::shared_lock lock(target.mutex);
+				for(auto iter = target.entries.cbegin(); iter != target.entries.cend(); ++iter)
+					fn(*iter);
+			}
+		}
+
+		/*
+		same as for_each, but shards are handed out to up to threads workers.
+		fn must be safe to call concurrently for entries of different shards.
+		*/
+		template<typename Fn>
+		void parallel_for_each(Fn &&fn, std::size_t threads = std::thread::hardware_concurrency()) const
+		{
+			threads = std::clamp<std::size_t>(threads, 1, Shards);
+			std::atomic<std::size_t> next{0};
+			auto worker = [this, &fn, &next]() {
+				for(std::size_t i = next.fetch_add(1, std::memory_order_relaxed); i < Shards; i = next.fetch_add(1, std::memory_order_relaxed))
+				{
+					std::shared_lock lock(shards_[i].mutex);
+					for(auto iter = shards_[i].entries.cbegin(); iter != shards_[i].entries.cend(); ++iter)
+						fn(*iter);
+				}
+			};
+
+			std::vector<std::thread> workers;
+			workers.reserve(threads - 1);
+			for(std::size_t i = 1; i < threads; ++i)
+				workers.emplace_back(worker);
+			worker();
+			for(std::thread &thread : workers)
+				thread.join();
+		}
+
+	private:
+		// keep shards on separate cache lines so their locks don't false share
+		struct alignas(64) shard
+		{
+			mutable std::shared_mutex mutex;
+			table entries;
+		};
+
+		template<typename K>
+		std::size_t shard_index(const K &key) const noexcept
+		{
+			if constexpr(Shards == 1)
+				return 0;
+			else
+			{
+				/*
+				the shard takes the top bits, lazy_flat_index uses the low ones.
+				*/
+				std::uint64_t hash = lazy_flat_index::mix(hasher(key));
+				return static_cast<std::size_t>(hash >> (64 - std::countr_zero(Shards)));
+			}
+		}
+
+		template<typename K>
+		shard &shard_of(const K &key) noexcept
+		{
+			return shards_[shard_index(key)];
+		}
+
+		template<typename K>
+		const shard &shard_of(const K &key) const noexcept
+		{
+			return shards_[shard_index(key)];
+		}
+
+		std::array<shard, Shards> shards_;
+		[[no_unique_address]] Hash hasher;
+	};
+} // namespace libsugarx
+
+#endif // LIBSUGARX_CONCURRENT_LAZYTABLE_H
@@ -0,0 +1,306 @@
+#ifndef LIBSUGARX_DIGEST_H
+#define LIBSUGARX_DIGEST_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#if defined(__SHA__) && defined(__SSSE3__)
+#include <immintrin.h>
+#define LIBSUGARX_HAS_SHA_NI 1
+#endif
+
+#include "sugar_types.h"
+
+namespace libsugarx
+{
+	/*
+	class block_digest
+	streaming Merkle–Damgård hash over 64-byte blocks, usable in constant expressions.
+	Traits gives the initial state, the block function and the byte order of words and length.
+	finish() works on a copy, so a state can absorb a common prefix once and be copied per message.
+	not for security, MD5 and SHA-1 are only here for name-based UUIDs and checksums.
+	*/
+	template<typename Traits>
+	class block_digest
+	{
+	public:
+		static constexpr std::size_t block_size = 64;
+		static constexpr std::size_t digest_size = Traits::digest_size;
+		using digest_type = std::array<std::byte, digest_size>;
+
+		constexpr block_digest() noexcept = default;
+
+		constexpr block_digest &update(std::string_view data) noexcept
+		{
+			absorb(data.data(), data.size());
+			return *this;
+		}
+
+		constexpr block_digest &update(const_data_span data) noexcept
+		{
+			absorb(data.data(), data.size());
+			return *this;
+		}
+
+		constexpr digest_type finish() const noexcept
+		{
+			block_digest padded = *this;
+			std::uint64_t bits = length_ * 8;
+			std::size_t used = static_cast<std::size_t>(length_ % block_size);
+			std::array<unsigned char, block_size + 8> tail{};
+			tail[0] = 0x80;
+			std::size_t zeros = used < 56 ? 56 - used : 120 - used;
+			for(std::size_t i = 0; i < 8; ++i)
+				tail[zeros + i] = static_cast<unsigned char>(bits >> (Traits::big_endian ? 56 - 8 * i : 8 * i));
+			padded.absorb(tail.data(), zeros + 8);
+
+			digest_type digest{};
+			for(std::size_t i = 0; i < digest_size; ++i)
+			{
+				std::uint32_t word = padded.state_[i / 4];
+				int shift = Traits::big_endian ? 24 - 8 * static_cast<int>(i % 4) : 8 * static_cast<int>(i % 4);
+				digest[i] = static_cast<std::byte>(word >> shift);
+			}
+			return digest;
+		}
+
+		static constexpr digest_type hash(std::string_view data) noexcept
+		{
+			return block_digest().update(data).finish();
+		}
+
+	private:
+		template<typename Byte>
+		constexpr void absorb(const Byte *data, std::size_t size) noexcept
+		{
+			std::size_t used = static_cast<std::size_t>(length_ % block_size);
+			length_ += size;
+			if(used != 0)
+			{
+				std::size_t take = std::min(block_size - used, size);
+				for(std::size_t i = 0; i < take; ++i)
+					buffer_[used + i] = static_cast<unsigned char>(data[i]);
+				data += take;
+				size -= take;
+				if(used + take < block_size)
+					return;
+				Traits::compress(state_, buffer_.data(), 1);
+			}
+
+			std::size_t blocks = size / block_size;
+			if !consteval
+			{
+				// whole blocks straight from the input
+				if(blocks != 0)
+					Traits::compress(state_, reinterpret_cast<const unsigned char *>(data), blocks);
+			}
+			else
+			{
+				for(std::size_t block = 0; block < blocks; ++block)
+				{
+					for(std::size_t i = 0; i < block_size; ++i)
+						buffer_[i] = static_cast<unsigned char>(data[block * block_size + i]);
+					Traits::compress(state_, buffer_.data(), 1);
+				}
+			}
+			data += blocks * block_size;
+			size -= blocks * block_size;
+
+			for(std::size_t i = 0; i < size; ++i)
+				buffer_[i] = static_cast<unsigned char>(data[i]);
+		}
+
+		typename Traits::state_type state_ = Traits::initial_state;
+		std::array<unsigned char, block_size> buffer_{};
+		std::uint64_t length_ = 0;
+	};
+
+	struct md5_traits
+	{
+		static constexpr std::size_t digest_size = 16;
+		static constexpr bool big_endian = false;
+		using state_type = std::array<std::uint32_t, 4>;
+		static constexpr state_type initial_state{0x67452301U, 0xEFCDAB89U, 0x98BADCFEU, 0x10325476U};
+
+		static constexpr void compress(state_type &state, const unsigned char *blocks, std::size_t count) noexcept
+		{
+			for(; count > 0; --count, blocks += 64)
+			{
+				std::array<std::uint32_t, 16> x{};
+				for(std::size_t i = 0; i < 16; ++i)
+				{
+					x[i] = static_cast<std::uint32_t>(blocks[4 * i]) | (static_cast<std::uint32_t>(blocks[4 * i + 1]) << 8) |
+						(static_cast<std::uint32_t>(blocks[4 * i + 2]) << 16) | (static_cast<std::uint32_t>(blocks[4 * i + 3]) << 24);
+				}
+
+				state_type v = state;
+				[&]<std::size_t... I>(std::index_sequence<I...>) { (step<I>(v, x), ...); }(std::make_index_sequence<64>());
+				for(std::size_t i = 0; i < 4; ++i)
+					state[i] += v[i];
+			}
+		}
+
+	private:
+		static constexpr std::array<std::uint32_t, 64> k{
+			0xD76AA478U, 0xE8C7B756U, 0x242070DBU, 0xC1BDCEEEU, 0xF57C0FAFU, 0x4787C62AU, 0xA8304613U, 0xFD469501U,
+			0x698098D8U, 0x8B44F7AFU, 0xFFFF5BB1U, 0x895CD7BEU, 0x6B901122U, 0xFD987193U, 0xA679438EU, 0x49B40821U,
+			0xF61E2562U, 0xC040B340U, 0x265E5A51U, 0xE9B6C7AAU, 0xD62F105DU, 0x02441453U, 0xD8A1E681U, 0xE7D3FBC8U,
+			0x21E1CDE6U, 0xC33707D6U, 0xF4D50D87U, 0x455A14EDU, 0xA9E3E905U, 0xFCEFA3F8U, 0x676F02D9U, 0x8D2A4C8AU,
+			0xFFFA3942U, 0x8771F681U, 0x6D9D6122U, 0xFDE5380CU, 0xA4BEEA44U, 0x4BDECFA9U, 0xF6BB4B60U, 0xBEBFBC70U,
+			0x289B7EC6U, 0xEAA127FAU, 0xD4EF3085U, 0x04881D05U, 0xD9D4D039U, 0xE6DB99E5U, 0x1FA27CF8U, 0xC4AC5665U,
+			0xF4292244U, 0x432AFF97U, 0xAB9423A7U, 0xFC93A039U, 0x655B59C3U, 0x8F0CCC92U, 0xFFEFF47DU, 0x85845DD1U,
+			0x6FA87E4FU, 0xFE2CE6E0U, 0xA3014314U, 0x4E0811A1U, 0xF7537E82U, 0xBD3AF235U, 0x2AD7D2BBU, 0xEB86D391U,
+		};
+		static constexpr std::array<int, 16> shifts{7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21};
+
+		// the a/b/c/d roles rotate through v instead of moving values around
+		template<std::size_t I>
+		static constexpr void step(state_type &v, const std::array<std::uint32_t, 16> &x) noexcept
+		{
+			constexpr std::size_t a = (4 - I % 4) % 4;
+			constexpr std::size_t b = (5 - I % 4) % 4;
+			constexpr std::size_t c = (6 - I % 4) % 4;
+			constexpr std::size_t d = (7 - I % 4) % 4;
+			std::uint32_t f;
+			std::size_t g;
+			if constexpr(I < 16)
+			{
+				f = v[d] ^ (v[b] & (v[c] ^ v[d]));
+				g = I;
+			}
+			else if constexpr(I < 32)
+			{
+				f = v[c] ^ (v[d] & (v[b] ^ v[c]));
+				g = (5 * I + 1) % 16;
+			}
+			else if constexpr(I < 48)
+			{
+				f = v[b] ^ v[c] ^ v[d];
+				g = (3 * I + 5) % 16;
+			}
+			else
+			{
+				f = v[c] ^ (v[b] | ~v[d]);
+				g = (7 * I) % 16;
+			}
+			v[a] = v[b] + std::rotl(v[a] + f + k[I] + x[g], shifts[(I / 16) * 4 + I % 4]);
+		}
+	};
+
+	struct sha1_traits
+	{
+		static constexpr std::size_t digest_size = 20;
+		static constexpr bool big_endian = true;
+		using state_type = std::array<std::uint32_t, 5>;
+		static constexpr state_type initial_state{0x67452301U, 0xEFCDAB89U, 0x98BADCFEU, 0x10325476U, 0xC3D2E1F0U};
+
+		static constexpr void compress(state_type &state, const unsigned char *blocks, std::size_t count) noexcept
+		{
+			if !consteval
+			{
+#if defined(LIBSUGARX_HAS_SHA_NI)
+				compress_sha_ni(state, blocks, count);
+				return;
+#endif
+			}
+			for(; count > 0; --count, blocks += 64)
+			{
+				std::array<std::uint32_t, 16> w{};
+				for(std::size_t i = 0; i < 16; ++i)
+				{
+					w[i] = (static_cast<std::uint32_t>(blocks[4 * i]) << 24) | (static_cast<std::uint32_t>(blocks[4 * i + 1]) << 16) |
+						(static_cast<std::uint32_t>(blocks[4 * i + 2]) << 8) | static_cast<std::uint32_t>(blocks[4 * i + 3]);
+				}
+
+				state_type v = state;
+				[&]<std::size_t... I>(std::index_sequence<I...>) { (step<I>(v, w), ...); }(std::make_index_sequence<80>());
+				for(std::size_t i = 0; i < 5; ++i)
+					state[i] += v[i];
+			}
+		}
+
+	private:
+		// the a..e roles rotate through v, w is the rolling 16-word schedule
+		template<std::size_t I>
+		static constexpr void step(state_type &v, std::array<std::uint32_t, 16> &w) noexcept
+		{
+			constexpr std::size_t a = (5 - I % 5) % 5;
+			constexpr std::size_t b = (6 - I % 5) % 5;
+			constexpr std::size_t c = (7 - I % 5) % 5;
+			constexpr std::size_t d = (8 - I % 5) % 5;
+			constexpr std::size_t e = (9 - I % 5) % 5;
+			if constexpr(I >= 16)
+				w[I % 16] = std::rotl(w[(I + 13) % 16] ^ w[(I + 8) % 16] ^ w[(I + 2) % 16] ^ w[I % 16], 1);
+
+			std::uint32_t f;
+			if constexpr(I < 20)
+				f = (v[d] ^ (v[b] & (v[c] ^ v[d]))) + 0x5A827999U;
+			else if constexpr(I < 40)
+				f = (v[b] ^ v[c] ^ v[d]) + 0x6ED9EBA1U;
+			else if constexpr(I < 60)
+				f = ((v[b] & v[c]) | (v[d] & (v[b] | v[c]))) + 0x8F1BBCDCU;
+			else
+				f = (v[b] ^ v[c] ^ v[d]) + 0xCA62C1D6U;
+			v[e] += std::rotl(v[a], 5) + f + w[I % 16];
+			v[b] = std::rotl(v[b], 30);
+		}
+
+#if defined(LIBSUGARX_HAS_SHA_NI)
+		// four rounds, the next group's E comes from this group's ABCD, messages are scheduled 3 groups ahead
+		template<int J>
+		static void sha_ni_group(__m128i &abcd, __m128i &e, __m128i (&msg)[4], const unsigned char *block) noexcept
+		{
+			if constexpr(J < 4)
+				msg[J] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * J)), _mm_set_epi64x(0x0001020304050607LL, 0x08090A0B0C0D0E0FLL));
+
+			__m128i e_in = J == 0 ? _mm_add_epi32(e, msg[0]) : _mm_sha1nexte_epu32(e, msg[J % 4]);
+			e = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e_in, J / 5);
+
+			if constexpr(J >= 3 && J <= 18)
+				msg[(J + 1) % 4] = _mm_sha1msg2_epu32(msg[(J + 1) % 4], msg[J % 4]);
+			if constexpr(J >= 1 && J <= 16)
+				msg[(J + 3) % 4] = _mm_sha1msg1_epu32(msg[(J + 3) % 4], msg[J % 4]);
+			if constexpr(J >= 2 && J <= 17)
+				msg[(J + 2) % 4] = _mm_xor_si128(msg[(J + 2) % 4], msg[J % 4]);
+		}
+
+		// one block with the state kept in locals, so the groups stay in registers
+		template<int... J>
+		static void sha_ni_block(__m128i &abcd_state, __m128i &e_state, const unsigned char *block, std::integer_sequence<int, J...>) noexcept
+		{
+			__m128i abcd = abcd_state;
+			__m128i e = e_state;
+			__m128i msg[4];
+			(sha_ni_group<J>(abcd, e, msg, block), ...);
+			e_state = _mm_sha1nexte_epu32(e, e_state);
+			abcd_state = _mm_add_epi32(abcd, abcd_state);
+		}
+
+		static void compress_sha_ni(state_type &state, const unsigned char *blocks, std::size_t count) noexcept
+		{
+#if defined(__AVX__)
+			// the SHA instructions only have legacy SSE forms, dirty upper vector state would stall every one
+			_mm256_zeroupper();
+#endif
+			__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state.data())), 0x1B);
+			__m128i e = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+			for(; count > 0; --count, blocks += 64)
+				sha_ni_block(abcd, e, blocks, std::make_integer_sequence<int, 20>());
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(state.data()), _mm_shuffle_epi32(abcd, 0x1B));
+			state[4] = static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(e, 12)));
+		}
+#endif
+	};
+
+	using md5 = block_digest<md5_traits>;
+	using sha1 = block_digest<sha1_traits>;
+} // namespace libsugarx
+
+#endif // LIBSUGARX_DIGEST_H
@@ -2,13 +2,30 @@
 #define LIBSUGARX_LAZYTABLE_H
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <optional>
-#include <set>
+#include <ranges>
+#include <span>
 #include <stdexcept>
-#include <unordered_map>
+#include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+#include "sugar_endian.h"
+
 namespace libsugarx
 {
 	template<typename Key, typename Value>
@@ -46,8 +63,7 @@ namespace libsugarx
 		lazy_flat_table_proxy *operator&() = delete;
 		const lazy_flat_table_proxy *operator&() const = delete;
 
-		constexpr Key key() noexcept { return key_; }
-		constexpr const Key key() const noexcept { return key_; }
+		constexpr const Key &key() const noexcept { return key_; }
 		constexpr void remove() noexcept { value_.reset(); }
 		constexpr bool is_removed() const noexcept { return !value_.has_value(); }
 		template<std::size_t I>
@@ -87,219 +103,1572 @@ namespace libsugarx
 	};
 
 	/*
-	class lazy_flat_table, a.k.a hashed_vector
-	not thread safe
+	class basic_lazy_slot_bitmap
+	a two-level bitmap of slot indices, one bit per slot.
+	set/reset never allocate, and the lowest set bit is found
+	by scanning one summary bit per 64 slots.
 	*/
-	template<typename Key, typename Value>
-	class lazy_flat_table
+	template<typename Allocator = std::allocator<std::byte>>
+	class basic_lazy_slot_bitmap
 	{
+		static constexpr std::size_t word_bits = 64;
+
+		using word_vector = std::vector<std::uint64_t, typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint64_t>>;
+
+		word_vector words_;
+		word_vector summary_;
+		std::size_t count_ = 0;
+		// no summary word before this one has a set bit
+		std::size_t summary_hint_ = 0;
+
 	public:
-		using proxy = lazy_flat_table_proxy<Key, Value>;
+		static constexpr std::size_t npos = static_cast<std::size_t>(-1);
 
-		lazy_flat_table() noexcept = default;
-		~lazy_flat_table() noexcept = default;
+		basic_lazy_slot_bitmap() = default;
+		explicit basic_lazy_slot_bitmap(const Allocator &alloc) : words_(alloc), summary_(alloc) {}
 
-		lazy_flat_table(lazy_flat_table<Key, Value> &&other) noexcept = default;
-		lazy_flat_table<Key, Value> &operator=(lazy_flat_table &&other) noexcept = default;
+		std::size_t count() const noexcept { return count_; }
+		bool empty() const noexcept { return count_ == 0; }
+
+		std::size_t allocated_bytes() const noexcept
+		{
+			return (words_.capacity() + summary_.capacity()) * sizeof(std::uint64_t);
+		}
 
-		template<typename... Args>
 		/*
-		need to check if return value is available.
+		bits beyond the new size must have been reset before shrinking.
 		*/
-		std::optional<std::reference_wrapper<proxy>> emplace(Key key, Args &&...args)
+		void resize(std::size_t bits)
 		{
-			if(index_table.count(key))
-				return std::nullopt;
-			if(removed_list.empty())
-			{
-				proxy &result = proxies.emplace_back(key, std::forward<Args>(args)...);
-				index_table[key] = proxies.size() - 1;
-				return result;
-			}
-			std::size_t begin = *removed_list.begin();
-			removed_list.erase(begin);
-			proxy &result = proxies[begin] = proxy(key, std::forward<Args>(args)...);
-			index_table[key] = begin;
-			return std::ref(result);
+			words_.resize((bits + word_bits - 1) / word_bits);
+			summary_.resize((words_.size() + word_bits - 1) / word_bits);
+			summary_hint_ = std::min(summary_hint_, summary_.size());
 		}
 
-		bool contains(const Key &key) const noexcept
+		bool test(std::size_t index) const noexcept
 		{
-			return index_table.count(key);
+			return (words_[index / word_bits] >> (index % word_bits)) & 1U;
 		}
 
-		/*
-		this is a C-style method, which means it wouldn't create new object automatically.
-		*/
-		proxy &operator[](const Key &key)
+		void set(std::size_t index) noexcept
 		{
-			return at(key);
+			std::size_t word = index / word_bits;
+			std::uint64_t bit = std::uint64_t(1) << (index % word_bits);
+			if(words_[word] & bit)
+				return;
+			words_[word] |= bit;
+			summary_[word / word_bits] |= std::uint64_t(1) << (word % word_bits);
+			summary_hint_ = std::min(summary_hint_, word / word_bits);
+			++count_;
 		}
 
-		proxy &at(const Key &key)
+		void reset(std::size_t index) noexcept
 		{
-			return proxies.at(index_table.at(key));
+			std::size_t word = index / word_bits;
+			std::uint64_t bit = std::uint64_t(1) << (index % word_bits);
+			if(!(words_[word] & bit))
+				return;
+			words_[word] &= ~bit;
+			if(words_[word] == 0)
+				summary_[word / word_bits] &= ~(std::uint64_t(1) << (word % word_bits));
+			--count_;
 		}
 
-		const proxy &at(const Key &key) const
+		/*
+		returns:
+		the lowest set bit, or npos if there is none.
+		*/
+		std::size_t find_first() noexcept
 		{
-			return proxies.at(index_table.at(key));
+			if(count_ == 0)
+				return npos;
+			while(summary_[summary_hint_] == 0)
+				++summary_hint_;
+			std::size_t word = summary_hint_ * word_bits + std::countr_zero(summary_[summary_hint_]);
+			return word * word_bits + std::countr_zero(words_[word]);
 		}
 
-		std::size_t size() const noexcept
+		/*
+		returns:
+		the lowest reset bit in [from, limit), or limit if there is none.
+		*/
+		std::size_t find_next_clear(std::size_t from, std::size_t limit) const noexcept
 		{
-			return index_table.size();
+			if(count_ == 0)
+				return std::min(from, limit);
+			while(from < limit)
+			{
+				std::size_t word = from / word_bits;
+				std::uint64_t clear_bits = ~words_[word] & (~std::uint64_t(0) << (from % word_bits));
+				if(clear_bits)
+					return std::min(word * word_bits + std::countr_zero(clear_bits), limit);
+				from = (word + 1) * word_bits;
+			}
+			return limit;
 		}
 
-		std::size_t allocated_size() const noexcept
+		/*
+		calls fn(index) for every reset bit in [first, limit), one word at a time.
+		*/
+		template<typename Fn>
+		void for_each_clear(std::size_t first, std::size_t limit, Fn &&fn) const
 		{
-			return proxies.size();
+			for(std::size_t base = first - first % word_bits; base < limit; base += word_bits)
+			{
+				std::uint64_t clear_bits = ~words_[base / word_bits];
+				if(base < first)
+					clear_bits &= ~std::uint64_t(0) << (first - base);
+				if(limit - base < word_bits)
+					clear_bits &= (std::uint64_t(1) << (limit - base)) - 1;
+				for(; clear_bits; clear_bits &= clear_bits - 1)
+					fn(base + std::countr_zero(clear_bits));
+			}
 		}
 
-		bool empty() const noexcept
+		template<typename Fn>
+		void for_each_clear(std::size_t limit, Fn &&fn) const
 		{
-			return index_table.empty();
+			for_each_clear(0, limit, fn);
 		}
 
-		bool allocated_empty() const noexcept
+		void clear() noexcept
 		{
-			return index_table.empty() && proxies.empty();
+			words_.clear();
+			summary_.clear();
+			count_ = 0;
+			summary_hint_ = 0;
 		}
+	};
 
-		void force_compact() noexcept
+	using lazy_slot_bitmap = basic_lazy_slot_bitmap<>;
+
+	inline void lazy_prefetch(const void *address) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_prefetch(static_cast<const char *>(address), _MM_HINT_T0);
+#else
+		(void)address;
+#endif
+	}
+
+	/*
+	class lazy_flat_index_base
+	control byte layout and probing shared by every lazy_flat_index
+	and by views over serialized indexes.
+	*/
+	class lazy_flat_index_base
+	{
+	public:
+		static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+		static constexpr std::size_t group_width = 8;
+
+		/*
+		finalizer applied on top of the user hash,
+		std::hash of integers is the identity on most platforms.
+		*/
+		static constexpr std::size_t mix(std::size_t hash) noexcept
 		{
-			std::vector<proxy> new_vec;
-			/*
-			rebuild map
-			*/
-			index_table.clear();
-			for(std::size_t i = 0; i < proxies.size(); ++i)
+			std::uint64_t h = hash;
+			h ^= h >> 33;
+			h *= 0xFF51AFD7ED558CCDULL;
+			h ^= h >> 33;
+			h *= 0xC4CEB9FE1A85EC53ULL;
+			h ^= h >> 33;
+			return static_cast<std::size_t>(h);
+		}
+
+		static constexpr bool is_full(std::uint8_t control) noexcept { return !(control & 0x80); }
+
+		/*
+		find over raw control bytes, e.g. a mapped snapshot.
+		slot_at(pos) reads the slot index stored at a position.
+		*/
+		template<typename SlotAt, typename Matches>
+		static std::size_t find_in(const std::uint8_t *controls, std::size_t capacity, std::size_t hash, SlotAt &&slot_at, Matches &&matches)
+		{
+			if(capacity == 0)
+				return npos;
+			std::uint8_t tag = hash_tag(hash);
+			std::size_t mask = capacity / group_width - 1;
+			std::size_t group = hash_group(hash) & mask;
+			for(std::size_t step = 1; step <= mask + 1; ++step)
 			{
-				if(!proxies[i].is_removed())
+				std::uint64_t bits = load_group(controls, group);
+				for(std::uint64_t match = match_tag(bits, tag); match; match &= match - 1)
 				{
-					index_table[proxies[i].key()] = new_vec.size();
-					new_vec.push_back(std::move(proxies[i]));
+					std::size_t pos = group * group_width + first_match(match);
+					if(matches(slot_at(pos)))
+						return pos;
 				}
+				if(match_empty(bits))
+					return npos;
+				group = (group + step) & mask;
 			}
-			std::swap(new_vec, proxies);
-			removed_list.clear();
+			return npos;
 		}
 
-		void compact() noexcept
+	protected:
+		static constexpr std::uint8_t empty_control = 0x80;
+		static constexpr std::uint8_t deleted_control = 0xFE;
+		static constexpr std::uint64_t lsbs = 0x0101010101010101ULL;
+		static constexpr std::uint64_t msbs = 0x8080808080808080ULL;
+
+		static constexpr std::uint8_t hash_tag(std::size_t hash) noexcept { return hash & 0x7F; }
+		static constexpr std::size_t hash_group(std::size_t hash) noexcept { return hash >> 7; }
+		static constexpr std::size_t max_load(std::size_t capacity) noexcept { return capacity - capacity / 8; }
+
+		/*
+		may report false positives after a real match,
+		which are filtered by the caller's key compare.
+		*/
+		static constexpr std::uint64_t match_tag(std::uint64_t group, std::uint8_t tag) noexcept
+		{
+			std::uint64_t x = group ^ (lsbs * tag);
+			return (x - lsbs) & ~x & msbs;
+		}
+
+		static constexpr std::uint64_t match_empty(std::uint64_t group) noexcept
+		{
+			return group & ~(group << 6) & msbs;
+		}
+
+		static constexpr std::uint64_t match_available(std::uint64_t group) noexcept
+		{
+			return group & msbs;
+		}
+
+		static constexpr std::size_t first_match(std::uint64_t match) noexcept
+		{
+			return std::countr_zero(match) / 8;
+		}
+
+		static std::uint64_t load_group(const std::uint8_t *controls, std::size_t group) noexcept
+		{
+			std::uint64_t bits;
+			std::memcpy(&bits, controls + group * group_width, sizeof(bits));
+			return to_little_endian(bits);
+		}
+	};
+
+	/*
+	class basic_lazy_flat_index
+	open-addressing hash index which stores slot indices only,
+	keys are compared by the caller through the slot.
+	each position owns a control byte with 7 bits of the hash,
+	and a group of 8 control bytes is matched in one word.
+	*/
+	template<typename Allocator = std::allocator<std::byte>>
+	class basic_lazy_flat_index : public lazy_flat_index_base
+	{
+		using control_vector = std::vector<std::uint8_t, typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint8_t>>;
+		using slot_vector = std::vector<std::size_t, typename std::allocator_traits<Allocator>::template rebind_alloc<std::size_t>>;
+
+		control_vector controls_;
+		slot_vector slots_;
+		std::size_t size_ = 0;
+		// empty positions which may still be used before a rehash
+		std::size_t growth_left_ = 0;
+
+		std::size_t group_mask() const noexcept
+		{
+			return controls_.size() / group_width - 1;
+		}
+
+		std::uint64_t load_group(std::size_t group) const noexcept
+		{
+			return lazy_flat_index_base::load_group(controls_.data(), group);
+		}
+
+		std::size_t find_available(std::size_t hash) const noexcept
 		{
-			while(!removed_list.empty() && !proxies.empty() && *removed_list.rbegin() == proxies.size() - 1)
+			std::size_t group = hash_group(hash) & group_mask();
+			for(std::size_t step = 1;; ++step)
 			{
-				removed_list.erase(*removed_list.rbegin());
-				proxies.pop_back();
+				std::uint64_t available = match_available(load_group(group));
+				if(available)
+					return group * group_width + first_match(available);
+				group = (group + step) & group_mask();
 			}
-			if(removed_list.size() > proxies.size() / 2)
+		}
+
+		template<typename HashOf>
+		void rehash(std::size_t capacity, HashOf &&hash_of)
+		{
+			control_vector old_controls(capacity, empty_control, controls_.get_allocator());
+			slot_vector old_slots(capacity, 0, slots_.get_allocator());
+			std::swap(old_controls, controls_);
+			std::swap(old_slots, slots_);
+			growth_left_ = max_load(capacity) - size_;
+			for(std::size_t i = 0; i < old_controls.size(); ++i)
 			{
-				force_compact();
+				if(!is_full(old_controls[i]))
+					continue;
+				std::size_t hash = hash_of(old_slots[i]);
+				std::size_t pos = find_available(hash);
+				controls_[pos] = hash_tag(hash);
+				slots_[pos] = old_slots[i];
 			}
 		}
 
-		void reserve(std::size_t size)
+	public:
+		basic_lazy_flat_index() = default;
+		explicit basic_lazy_flat_index(const Allocator &alloc) : controls_(alloc), slots_(alloc) {}
+
+		std::size_t size() const noexcept { return size_; }
+		std::size_t capacity() const noexcept { return controls_.size(); }
+		bool empty() const noexcept { return size_ == 0; }
+
+		std::size_t allocated_bytes() const noexcept
 		{
-			proxies.reserve(size);
-			index_table.reserve(size);
+			return controls_.capacity() * sizeof(std::uint8_t) + slots_.capacity() * sizeof(std::size_t);
 		}
 
+		std::size_t slot(std::size_t pos) const noexcept { return slots_[pos]; }
+		void set_slot(std::size_t pos, std::size_t slot) noexcept { slots_[pos] = slot; }
+
 		/*
-		returns true as the variable exists
+		returns:
+		position of the slot accepted by matches, or npos.
 		*/
-		bool lazy_remove(const Key &key)
+		template<typename Matches>
+		std::size_t find(std::size_t hash, Matches &&matches) const
 		{
-			auto iter = index_table.find(key);
-			if(iter != index_table.end() && !proxies[iter->second].is_removed())
-			{
-				proxies[iter->second].remove();
-				index_table.erase(key);
-				removed_list.insert(iter->second);
-				return true;
-			}
-			return false;
+			return find_in(controls_.data(), controls_.size(), hash, [this](std::size_t pos) { return slots_[pos]; }, matches);
 		}
 
-		void clear()
-		{
-			removed_list.clear();
-			index_table.clear();
-			proxies.clear();
-		}
+		/*
+		raw control bytes, the high bit is set on empty and deleted positions.
+		*/
+		std::span<const std::uint8_t> controls() const noexcept { return controls_; }
 
 		/*
-		as this would compact the vector list,
-		it's not a lazy method, :3
+		replaces the index by prebuilt control bytes,
+		slot_at(pos) gives the slot of every full position.
+		returns false and leaves the index empty unless the full positions
+		refer to every slot below slot_count exactly once.
 		*/
-		void remove(const Key &key)
+		template<typename SlotAt>
+		bool assign(std::span<const std::uint8_t> controls, SlotAt &&slot_at, std::size_t slot_count)
 		{
-			if(lazy_remove(key))
-				compact();
+			controls_.assign(controls.begin(), controls.end());
+			slots_.assign(controls.size(), 0);
+			size_ = 0;
+			std::size_t used = 0;
+			std::vector<bool> seen(slot_count);
+			for(std::size_t pos = 0; pos < controls.size(); ++pos)
+			{
+				if(controls[pos] == empty_control)
+					continue;
+				++used;
+				if(is_full(controls[pos]))
+				{
+					std::size_t slot = slot_at(pos);
+					if(slot >= slot_count || seen[slot])
+					{
+						clear();
+						return false;
+					}
+					seen[slot] = true;
+					slots_[pos] = slot;
+					++size_;
+				}
+			}
+			if(size_ != slot_count)
+			{
+				clear();
+				return false;
+			}
+			growth_left_ = max_load(controls.size()) - std::min(used, max_load(controls.size()));
+			return true;
 		}
 
-		template<typename vec_iter>
-		class iterator_impl
+		/*
+		probes once for both lookup and insertion.
+		returns:
+		{position, true} if matches accepted a slot,
+		{position, false} if the key is missing, pass it to insert_at.
+		hash_of(slot) is used when the index has to grow.
+		*/
+		template<typename Matches, typename HashOf>
+		std::pair<std::size_t, bool> find_or_prepare_insert(std::size_t hash, Matches &&matches, HashOf &&hash_of)
 		{
-			vec_iter current_;
-			vec_iter end_;
-
-			void skip_to_available()
+			std::size_t available = npos;
+			if(!controls_.empty())
 			{
-				while(current_ != end_ && (*current_).is_removed())
+				std::uint8_t tag = hash_tag(hash);
+				std::size_t group = hash_group(hash) & group_mask();
+				for(std::size_t step = 1; step <= group_mask() + 1; ++step)
 				{
-					++current_;
+					std::uint64_t bits = load_group(group);
+					for(std::uint64_t match = match_tag(bits, tag); match; match &= match - 1)
+					{
+						std::size_t pos = group * group_width + first_match(match);
+						if(matches(slots_[pos]))
+							return {pos, true};
+					}
+					if(available == npos && match_available(bits))
+						available = group * group_width + first_match(match_available(bits));
+					if(match_empty(bits))
+						break;
+					group = (group + step) & group_mask();
 				}
 			}
+			if(available != npos && (growth_left_ > 0 || controls_[available] == deleted_control))
+				return {available, false};
 
-		public:
-			explicit iterator_impl(vec_iter it, vec_iter end) : current_(it), end_(end)
+			std::size_t capacity = controls_.size();
+			if(capacity == 0)
+				capacity = group_width;
+			else if(size_ >= max_load(capacity) / 2)
+				capacity *= 2;
+			rehash(capacity, hash_of);
+			return {find_available(hash), false};
+		}
+
+		void insert_at(std::size_t pos, std::size_t hash, std::size_t slot) noexcept
+		{
+			if(controls_[pos] == empty_control)
+				--growth_left_;
+			controls_[pos] = hash_tag(hash);
+			slots_[pos] = slot;
+			++size_;
+		}
+
+		void erase_at(std::size_t pos) noexcept
+		{
+			/*
+			a group which still has an empty position never ended a probe,
+			so the position may become empty again instead of a tombstone.
+			*/
+			if(match_empty(load_group(pos / group_width)))
+			{
+				controls_[pos] = empty_control;
+				++growth_left_;
+			}
+			else
 			{
-				skip_to_available();
+				controls_[pos] = deleted_control;
 			}
+			--size_;
+		}
+
+		/*
+		pulls the first probed group of hash towards the cache.
+		*/
+		void prefetch(std::size_t hash) const noexcept
+		{
+			if(controls_.empty())
+				return;
+			std::size_t pos = (hash_group(hash) & group_mask()) * group_width;
+			lazy_prefetch(controls_.data() + pos);
+			lazy_prefetch(slots_.data() + pos);
+		}
 
-			proxy &operator*() const { return *current_; }
+		template<typename HashOf>
+		void reserve(std::size_t size, HashOf &&hash_of)
+		{
+			std::size_t capacity = group_width;
+			while(max_load(capacity) < size)
+				capacity *= 2;
+			if(capacity > controls_.size())
+				rehash(capacity, hash_of);
+		}
 
-			iterator_impl &operator++()
+		void clear() noexcept
+		{
+			std::fill(controls_.begin(), controls_.end(), empty_control);
+			size_ = 0;
+			growth_left_ = max_load(controls_.size());
+		}
+	};
+
+	using lazy_flat_index = basic_lazy_flat_index<>;
+
+	/*
+	transparent hash for string-like keys,
+	std::string, std::string_view and fixed_string<N> hash to the same value,
+	use it with std::equal_to<> to probe a std::string table without building a key.
+	*/
+	struct transparent_string_hash
+	{
+		using is_transparent = void;
+
+		std::size_t operator()(std::string_view str) const noexcept
+		{
+			return std::hash<std::string_view>{}(str);
+		}
+	};
+
+	/*
+	struct lazy_flat_handle
+	slot index plus the generation of that slot when the handle was made,
+	the slot's generation is bumped whenever its entry leaves it,
+	so a handle turns stale after remove, reuse or compaction.
+	tables using handles must stay below 2^32 slots.
+	*/
+	struct lazy_flat_handle
+	{
+		std::uint32_t slot = 0;
+		std::uint32_t generation = 0;
+
+		auto operator<=>(const lazy_flat_handle &other) const = default;
+	};
+
+	template<typename Hash, typename KeyEqual>
+	concept lazy_transparent_lookup = requires {
+		typename Hash::is_transparent;
+		typename KeyEqual::is_transparent;
+	};
+
+	/*
+	class lazy_flat_table, a.k.a hashed_vector
+	not thread safe
+	heterogeneous lookup is enabled when both Hash and KeyEqual are transparent.
+	*/
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, typename Allocator = std::allocator<std::byte>>
+	class lazy_flat_table
+	{
+		template<typename T>
+		using rebind_alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+	public:
+		using proxy = lazy_flat_table_proxy<Key, Value>;
+		using allocator_type = Allocator;
+		using index_type = basic_lazy_flat_index<Allocator>;
+
+		lazy_flat_table() noexcept = default;
+		~lazy_flat_table() noexcept = default;
+
+		/*
+		every internal array is allocated from alloc.
+		*/
+		explicit lazy_flat_table(const Allocator &alloc) :
+				removed_slots(alloc),
+				proxies(alloc),
+				generations(alloc),
+				index_table(alloc)
+		{
+		}
+
+		allocator_type get_allocator() const noexcept { return allocator_type(proxies.get_allocator()); }
+
+		lazy_flat_table(lazy_flat_table &&other) noexcept = default;
+		lazy_flat_table &operator=(lazy_flat_table &&other) noexcept = default;
+
+		template<typename K, typename... Args>
+		requires std::same_as<std::remove_cvref_t<K>, Key> || (lazy_transparent_lookup<Hash, KeyEqual> && std::constructible_from<Key, K>)
+		/*
+		one probe for both lookup and insertion.
+		returns the existing proxy and false if key is already in use,
+		the key is only built from K when it is inserted.
+		*/
+		std::pair<std::reference_wrapper<proxy>, bool> try_emplace(K &&key, Args &&...args)
+		{
+			std::size_t hash = hash_of(key);
+			auto [pos, found] = index_table.find_or_prepare_insert(hash, key_matcher(key), slot_hasher());
+			if(found)
+				return {std::ref(proxies[index_table.slot(pos)]), false};
+
+			std::size_t slot;
+			if(removed_slots.empty())
 			{
-				++current_;
-				skip_to_available();
-				return *this;
+				proxies.emplace_back(Key(std::forward<K>(key)), std::forward<Args>(args)...);
+				removed_slots.resize(proxies.size());
+				slot = proxies.size() - 1;
+				if(generations.size() < proxies.size())
+					generations.push_back(0);
 			}
-
-			bool operator!=(const iterator_impl &other) const
+			else
 			{
-				return current_ != other.current_;
+				slot = removed_slots.find_first();
+				proxies[slot] = proxy(Key(std::forward<K>(key)), std::forward<Args>(args)...);
+				removed_slots.reset(slot);
 			}
-		};
+			index_table.insert_at(pos, hash, slot);
+			return {std::ref(proxies[slot]), true};
+		}
 
-		using iterator = iterator_impl<typename std::vector<proxy>::iterator>;
-		using const_iterator = iterator_impl<typename std::vector<proxy>::const_iterator>;
+		template<typename... Args>
+		/*
+		need to check if return value is available.
+		*/
+		std::optional<std::reference_wrapper<proxy>> emplace(Key key, Args &&...args)
+		{
+			auto [result, inserted] = try_emplace(std::move(key), std::forward<Args>(args)...);
+			if(!inserted)
+				return std::nullopt;
+			return result;
+		}
 
-		iterator begin()
+		template<typename... Args>
+		/*
+		like emplace, but returns a handle for hash-free access by get.
+		*/
+		std::optional<lazy_flat_handle> emplace_handle(Key key, Args &&...args)
 		{
-			return iterator(proxies.begin(), proxies.end());
+			auto [result, inserted] = try_emplace(std::move(key), std::forward<Args>(args)...);
+			if(!inserted)
+				return std::nullopt;
+			return handle_of_slot(std::addressof(result.get()) - proxies.data());
 		}
 
-		iterator end()
+		std::optional<lazy_flat_handle> handle_of(const Key &key) const noexcept
 		{
-			return iterator(proxies.end(), proxies.end());
+			std::size_t slot = find_slot(key);
+			if(slot == lazy_flat_index::npos)
+				return std::nullopt;
+			return handle_of_slot(slot);
 		}
 
-		const_iterator cbegin() const
+		/*
+		one bounds check and one generation compare, no hashing.
+		returns std::nullopt if the handle is stale.
+		*/
+		std::optional<std::reference_wrapper<proxy>> get(lazy_flat_handle handle) noexcept
 		{
-			return const_iterator(proxies.cbegin(), proxies.cend());
+			if(!is_valid(handle))
+				return std::nullopt;
+			return std::ref(proxies[handle.slot]);
 		}
 
-		const_iterator cend() const
+		std::optional<std::reference_wrapper<const proxy>> get(lazy_flat_handle handle) const noexcept
 		{
-			return const_iterator(proxies.cend(), proxies.cend());
+			if(!is_valid(handle))
+				return std::nullopt;
+			return std::cref(proxies[handle.slot]);
 		}
 
-	private:
-		std::multiset<std::size_t> removed_list;
-		std::vector<proxy> proxies;
-		std::unordered_map<Key, std::size_t> index_table;
-	};
+		/*
+		removed slots always carry a newer generation than their last handle,
+		so a matching generation implies a live slot.
+		*/
+		bool is_valid(lazy_flat_handle handle) const noexcept
+		{
+			return handle.slot < proxies.size() && generations[handle.slot] == handle.generation;
+		}
+
+		bool contains(const Key &key) const noexcept
+		{
+			return find_slot(key) != lazy_flat_index::npos;
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		bool contains(const K &key) const noexcept
+		{
+			return find_slot(key) != lazy_flat_index::npos;
+		}
+
+		/*
+		one probe, nullptr if key doesn't exist.
+		*/
+		proxy *find(const Key &key) noexcept
+		{
+			return proxy_at(find_slot(key));
+		}
+
+		const proxy *find(const Key &key) const noexcept
+		{
+			return proxy_at(find_slot(key));
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		proxy *find(const K &key) noexcept
+		{
+			return proxy_at(find_slot(key));
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		const proxy *find(const K &key) const noexcept
+		{
+			return proxy_at(find_slot(key));
+		}
+
+		/*
+		this is a C-style method, which means it wouldn't create new object automatically.
+		*/
+		proxy &operator[](const Key &key)
+		{
+			return at(key);
+		}
+
+		proxy &at(const Key &key)
+		{
+			return proxies[checked_slot(key)];
+		}
+
+		const proxy &at(const Key &key) const
+		{
+			return proxies[checked_slot(key)];
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		proxy &at(const K &key)
+		{
+			return proxies[checked_slot(key)];
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		const proxy &at(const K &key) const
+		{
+			return proxies[checked_slot(key)];
+		}
+
+		std::size_t size() const noexcept
+		{
+			return index_table.size();
+		}
+
+		std::size_t allocated_size() const noexcept
+		{
+			return proxies.size();
+		}
+
+		/*
+		bytes held by the table's own arrays,
+		memory owned by keys and values themselves is not included.
+		*/
+		std::size_t allocated_bytes() const noexcept
+		{
+			return proxies.capacity() * sizeof(proxy) + generations.capacity() * sizeof(std::uint32_t) +
+			       removed_slots.allocated_bytes() + index_table.allocated_bytes();
+		}
+
+		bool empty() const noexcept
+		{
+			return index_table.empty();
+		}
+
+		bool allocated_empty() const noexcept
+		{
+			return index_table.empty() && proxies.empty();
+		}
+
+		/*
+		keeps the order of live entries, moves them in place.
+		*/
+		void force_compact() noexcept
+		{
+			std::size_t live = 0;
+			removed_slots.for_each_clear(proxies.size(), [this, &live](std::size_t slot) {
+				if(slot != live)
+				{
+					proxies[live] = std::move(proxies[slot]);
+					++generations[slot];
+				}
+				++live;
+			});
+			proxies.erase(proxies.begin() + live, proxies.end());
+			removed_slots.clear();
+			removed_slots.resize(live);
+			compacting = false;
+			/*
+			rebuild index
+			*/
+			index_table.clear();
+			for(std::size_t i = 0; i < live; ++i)
+			{
+				std::size_t hash = hash_of(proxies[i].key());
+				auto [pos, found] = index_table.find_or_prepare_insert(hash, no_match, slot_hasher());
+				index_table.insert_at(pos, hash, i);
+			}
+		}
+
+		/*
+		moves at most budget live entries from the tail into the lowest removed slots,
+		patching their index entries in place, then trims the tail.
+		doesn't keep the order of live entries.
+		returns the number of moved entries.
+		*/
+		std::size_t compact_step(std::size_t budget) noexcept
+		{
+			std::size_t moved = 0;
+			trim_tail();
+			while(moved < budget && !removed_slots.empty())
+			{
+				std::size_t hole = removed_slots.find_first();
+				std::size_t last = proxies.size() - 1;
+				std::size_t pos = index_table.find(hash_of(proxies[last].key()), [last](std::size_t slot) { return slot == last; });
+				index_table.set_slot(pos, hole);
+				proxies[hole] = std::move(proxies[last]);
+				proxies.pop_back();
+				removed_slots.reset(hole);
+				++generations[last];
+				++moved;
+				trim_tail();
+			}
+			if(removed_slots.empty())
+				compacting = false;
+			return moved;
+		}
+
+		/*
+		budget > 0: compact moves at most budget entries per call, and keeps
+		stepping on later calls until no removed slot is left.
+		budget = 0: compact falls back to force_compact.
+		*/
+		void set_incremental_compaction(std::size_t budget) noexcept
+		{
+			compaction_budget = budget;
+		}
+
+		void compact() noexcept
+		{
+			trim_tail();
+			if(compaction_budget > 0)
+			{
+				if(compacting || removed_slots.count() > proxies.size() / 2)
+				{
+					compacting = true;
+					compact_step(compaction_budget);
+				}
+			}
+			else if(removed_slots.count() > proxies.size() / 2)
+			{
+				force_compact();
+			}
+		}
+
+		void reserve(std::size_t size)
+		{
+			proxies.reserve(size);
+			index_table.reserve(size, slot_hasher());
+		}
+
+		/*
+		replaces the content by dense entries and an index already built over them,
+		slot i of the index refers to keys[i] and values[i].
+		used to load snapshots without rehashing.
+		*/
+		void assign_indexed(std::span<const Key> keys, std::span<const Value> values, index_type &&index)
+		{
+			clear();
+			proxies.reserve(keys.size());
+			for(std::size_t i = 0; i < keys.size(); ++i)
+				proxies.emplace_back(keys[i], values[i]);
+			removed_slots.resize(proxies.size());
+			if(generations.size() < proxies.size())
+				generations.resize(proxies.size(), 0);
+			index_table = std::move(index);
+		}
+
+		template<std::input_iterator Iter, std::sentinel_for<Iter> Sentinel>
+		/*
+		emplaces every pair-like (key, value) element,
+		storage and index are sized once when the length is known up front.
+		returns the number of inserted entries.
+		*/
+		std::size_t emplace_range(Iter first, Sentinel last)
+		{
+			if constexpr(std::forward_iterator<Iter>)
+			{
+				std::size_t count = static_cast<std::size_t>(std::ranges::distance(first, last));
+				std::size_t fresh = count > removed_slots.count() ? count - removed_slots.count() : 0;
+				proxies.reserve(proxies.size() + fresh);
+				index_table.reserve(size() + count, slot_hasher());
+			}
+
+			std::size_t inserted = 0;
+			for(; first != last; ++first)
+			{
+				auto &&[key, value] = *first;
+				if constexpr(std::same_as<std::remove_cvref_t<decltype(key)>, Key>)
+					inserted += try_emplace(key, value).second;
+				else
+					inserted += try_emplace(Key(key), value).second;
+			}
+			return inserted;
+		}
+
+		template<std::ranges::input_range Range>
+		std::size_t insert_bulk(Range &&range)
+		{
+			return emplace_range(std::ranges::begin(range), std::ranges::end(range));
+		}
+
+		template<typename Pred>
+		/*
+		removes every entry accepted by pred(const proxy &) in one pass,
+		then compacts once.
+		returns the number of removed entries.
+		*/
+		std::size_t remove_if(Pred pred)
+		{
+			std::size_t removed = 0;
+			removed_slots.for_each_clear(proxies.size(), [this, &pred, &removed](std::size_t slot) {
+				if(!pred(std::as_const(proxies[slot])))
+					return;
+				std::size_t pos = index_table.find(hash_of(proxies[slot].key()), [slot](std::size_t other) { return other == slot; });
+				erase_at(pos, slot);
+				++removed;
+			});
+			if(removed > 0)
+				compact();
+			return removed;
+		}
+
+		/*
+		lazily removes all keys, then compacts once.
+		returns the number of removed entries.
+		*/
+		std::size_t erase_batch(std::span<const Key> keys)
+		{
+			std::size_t removed = 0;
+			for(const Key &key : keys)
+				removed += lazy_remove_impl(key);
+			if(removed > 0)
+				compact();
+			return removed;
+		}
+
+		/*
+		looks keys up in blocks, the index groups of a whole block
+		are prefetched before any of them is probed.
+		out[i] is nullptr when keys[i] doesn't exist.
+		returns the number of found keys.
+		*/
+		std::size_t multi_get(std::span<const Key> keys, std::span<proxy *> out)
+		{
+			return multi_get_impl(keys, [this, out](std::size_t i, std::size_t slot) {
+				out[i] = slot == lazy_flat_index::npos ? nullptr : std::addressof(proxies[slot]);
+			}, out.size());
+		}
+
+		std::size_t multi_get(std::span<const Key> keys, std::span<const proxy *> out) const
+		{
+			return multi_get_impl(keys, [this, out](std::size_t i, std::size_t slot) {
+				out[i] = slot == lazy_flat_index::npos ? nullptr : std::addressof(proxies[slot]);
+			}, out.size());
+		}
+
+		template<typename Fn>
+		/*
+		calls fn(proxy &) for every live entry, the slots are split
+		into contiguous chunks handed to up to threads workers.
+		fn must be safe to call concurrently and must not modify the table itself.
+		*/
+		void parallel_for_each(Fn &&fn, std::size_t threads = std::thread::hardware_concurrency())
+		{
+			parallel_slots(threads, [this, &fn](std::size_t slot) { fn(proxies[slot]); });
+		}
+
+		template<typename Fn>
+		/*
+		replaces every live value by fn(const proxy &), split like parallel_for_each.
+		*/
+		void parallel_transform(Fn &&fn, std::size_t threads = std::thread::hardware_concurrency())
+		{
+			parallel_slots(threads, [this, &fn](std::size_t slot) { proxies[slot].value() = fn(std::as_const(proxies[slot])); });
+		}
+
+		/*
+		returns true as the variable exists
+		*/
+		bool lazy_remove(const Key &key)
+		{
+			return lazy_remove_impl(key);
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		bool lazy_remove(const K &key)
+		{
+			return lazy_remove_impl(key);
+		}
+
+		/*
+		generations are kept, so handles taken before clear stay stale.
+		*/
+		void clear()
+		{
+			removed_slots.for_each_clear(proxies.size(), [this](std::size_t slot) { ++generations[slot]; });
+			removed_slots.clear();
+			index_table.clear();
+			proxies.clear();
+			compacting = false;
+		}
+
+		/*
+		as this would compact the vector list,
+		it's not a lazy method, :3
+		*/
+		void remove(const Key &key)
+		{
+			if(lazy_remove(key))
+				compact();
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		void remove(const K &key)
+		{
+			if(lazy_remove(key))
+				compact();
+		}
+
+		/*
+		skips removed slots with word-level scans of the removed bitmap.
+		*/
+		template<typename table_proxy>
+		class iterator_impl
+		{
+			table_proxy *proxies_;
+			const basic_lazy_slot_bitmap<Allocator> *removed_;
+			std::size_t current_;
+			std::size_t end_;
+
+		public:
+			explicit iterator_impl(table_proxy *proxies, const basic_lazy_slot_bitmap<Allocator> *removed, std::size_t it, std::size_t end) :
+					proxies_(proxies),
+					removed_(removed),
+					current_(removed->find_next_clear(it, end)),
+					end_(end)
+			{
+			}
+
+			table_proxy &operator*() const { return proxies_[current_]; }
+
+			iterator_impl &operator++()
+			{
+				current_ = removed_->find_next_clear(current_ + 1, end_);
+				return *this;
+			}
+
+			bool operator!=(const iterator_impl &other) const
+			{
+				return current_ != other.current_;
+			}
+		};
+
+		using iterator = iterator_impl<proxy>;
+		using const_iterator = iterator_impl<const proxy>;
+
+		iterator begin()
+		{
+			return iterator(proxies.data(), &removed_slots, 0, proxies.size());
+		}
+
+		iterator end()
+		{
+			return iterator(proxies.data(), &removed_slots, proxies.size(), proxies.size());
+		}
+
+		const_iterator cbegin() const
+		{
+			return const_iterator(proxies.data(), &removed_slots, 0, proxies.size());
+		}
+
+		const_iterator cend() const
+		{
+			return const_iterator(proxies.data(), &removed_slots, proxies.size(), proxies.size());
+		}
+
+	private:
+		static constexpr bool no_match(std::size_t) noexcept { return false; }
+
+		template<typename K>
+		std::size_t hash_of(const K &key) const noexcept
+		{
+			return lazy_flat_index::mix(hasher(key));
+		}
+
+		template<typename K>
+		auto key_matcher(const K &key) const noexcept
+		{
+			return [this, &key](std::size_t slot) { return key_equal(proxies[slot].key(), key); };
+		}
+
+		void trim_tail() noexcept
+		{
+			while(!removed_slots.empty() && !proxies.empty() && removed_slots.test(proxies.size() - 1))
+			{
+				removed_slots.reset(proxies.size() - 1);
+				proxies.pop_back();
+			}
+			removed_slots.resize(proxies.size());
+		}
+
+		lazy_flat_handle handle_of_slot(std::size_t slot) const noexcept
+		{
+			return {static_cast<std::uint32_t>(slot), generations[slot]};
+		}
+
+		auto slot_hasher() const noexcept
+		{
+			return [this](std::size_t slot) { return hash_of(proxies[slot].key()); };
+		}
+
+		template<typename K>
+		std::size_t find_slot(const K &key) const noexcept
+		{
+			std::size_t pos = index_table.find(hash_of(key), key_matcher(key));
+			return pos == lazy_flat_index::npos ? pos : index_table.slot(pos);
+		}
+
+		template<typename K>
+		std::size_t checked_slot(const K &key) const
+		{
+			std::size_t slot = find_slot(key);
+			if(slot == lazy_flat_index::npos)
+				throw std::out_of_range("Key not found");
+			return slot;
+		}
+
+		proxy *proxy_at(std::size_t slot) noexcept
+		{
+			return slot == lazy_flat_index::npos ? nullptr : std::addressof(proxies[slot]);
+		}
+
+		const proxy *proxy_at(std::size_t slot) const noexcept
+		{
+			return slot == lazy_flat_index::npos ? nullptr : std::addressof(proxies[slot]);
+		}
+
+		template<typename K>
+		bool lazy_remove_impl(const K &key)
+		{
+			std::size_t pos = index_table.find(hash_of(key), key_matcher(key));
+			if(pos == lazy_flat_index::npos)
+				return false;
+			erase_at(pos, index_table.slot(pos));
+			return true;
+		}
+
+		void erase_at(std::size_t pos, std::size_t slot) noexcept
+		{
+			proxies[slot].remove();
+			removed_slots.set(slot);
+			++generations[slot];
+			index_table.erase_at(pos);
+		}
+
+		template<typename Store>
+		std::size_t multi_get_impl(std::span<const Key> keys, Store &&store, std::size_t out_size) const
+		{
+			constexpr std::size_t block = 16;
+			std::array<std::size_t, block> hashes;
+			std::size_t count = std::min(keys.size(), out_size);
+			std::size_t found = 0;
+			for(std::size_t base = 0; base < count; base += block)
+			{
+				std::size_t length = std::min(block, count - base);
+				for(std::size_t i = 0; i < length; ++i)
+				{
+					hashes[i] = hash_of(keys[base + i]);
+					index_table.prefetch(hashes[i]);
+				}
+				for(std::size_t i = 0; i < length; ++i)
+				{
+					std::size_t pos = index_table.find(hashes[i], key_matcher(keys[base + i]));
+					std::size_t slot = pos == lazy_flat_index::npos ? pos : index_table.slot(pos);
+					found += slot != lazy_flat_index::npos;
+					store(base + i, slot);
+				}
+			}
+			return found;
+		}
+
+		template<typename Fn>
+		void parallel_slots(std::size_t threads, Fn &&fn)
+		{
+			// small tables stay on the calling thread
+			constexpr std::size_t min_chunk = 4096;
+			std::size_t count = proxies.size();
+			threads = std::min(std::max<std::size_t>(threads, 1), std::max<std::size_t>((count + min_chunk - 1) / min_chunk, 1));
+			// whole bitmap words per worker
+			std::size_t chunk = ((count + threads - 1) / threads + 63) / 64 * 64;
+			auto worker = [this, &fn, chunk, count](std::size_t index) {
+				std::size_t first = index * chunk;
+				if(first < count)
+					removed_slots.for_each_clear(first, std::min(count, first + chunk), fn);
+			};
+
+			std::vector<std::thread> workers;
+			workers.reserve(threads - 1);
+			for(std::size_t i = 1; i < threads; ++i)
+				workers.emplace_back(worker, i);
+			worker(0);
+			for(std::thread &thread : workers)
+				thread.join();
+		}
+
+		basic_lazy_slot_bitmap<Allocator> removed_slots;
+		std::vector<proxy, rebind_alloc<proxy>> proxies;
+		// one per slot ever allocated, never shrinks
+		std::vector<std::uint32_t, rebind_alloc<std::uint32_t>> generations;
+		std::size_t compaction_budget = 0;
+		bool compacting = false;
+		index_type index_table;
+		[[no_unique_address]] Hash hasher;
+		[[no_unique_address]] KeyEqual key_equal;
+	};
+	/*
+	class lazy_soa_table
+	structure-of-arrays flavour of lazy_flat_table.
+	keys, values and removed bits are kept in separate arrays,
+	so a pass over one column only streams that column's memory.
+	removed slots hold a default constructed value until reused.
+	not thread safe
+	*/
+	template<typename Key, std::default_initializable Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, typename Allocator = std::allocator<std::byte>>
+	class lazy_soa_table
+	{
+		template<typename T>
+		using rebind_alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+	public:
+		using allocator_type = Allocator;
+
+		lazy_soa_table() noexcept = default;
+		~lazy_soa_table() noexcept = default;
+
+		/*
+		every internal array is allocated from alloc.
+		*/
+		explicit lazy_soa_table(const Allocator &alloc) :
+				removed_slots(alloc),
+				keys_(alloc),
+				values_(alloc),
+				index_table(alloc)
+		{
+		}
+
+		allocator_type get_allocator() const noexcept { return allocator_type(keys_.get_allocator()); }
+
+		lazy_soa_table(lazy_soa_table &&other) noexcept = default;
+		lazy_soa_table &operator=(lazy_soa_table &&other) noexcept = default;
+
+		template<typename K, typename... Args>
+		requires std::same_as<std::remove_cvref_t<K>, Key> || (lazy_transparent_lookup<Hash, KeyEqual> && std::constructible_from<Key, K>)
+		/*
+		returns the existing value and false if key is already in use.
+		*/
+		std::pair<std::reference_wrapper<Value>, bool> try_emplace(K &&key, Args &&...args)
+		{
+			std::size_t hash = hash_of(key);
+			auto [pos, found] = index_table.find_or_prepare_insert(hash, key_matcher(key), slot_hasher());
+			if(found)
+				return {std::ref(values_[index_table.slot(pos)]), false};
+
+			std::size_t slot;
+			if(removed_slots.empty())
+			{
+				values_.emplace_back(std::forward<Args>(args)...);
+				try
+				{
+					keys_.emplace_back(std::forward<K>(key));
+				}
+				catch(...)
+				{
+					values_.pop_back();
+					throw;
+				}
+				removed_slots.resize(keys_.size());
+				slot = keys_.size() - 1;
+			}
+			else
+			{
+				slot = removed_slots.find_first();
+				values_[slot] = Value(std::forward<Args>(args)...);
+				keys_[slot] = Key(std::forward<K>(key));
+				removed_slots.reset(slot);
+			}
+			index_table.insert_at(pos, hash, slot);
+			return {std::ref(values_[slot]), true};
+		}
+
+		template<typename... Args>
+		/*
+		need to check if return value is available.
+		*/
+		std::optional<std::reference_wrapper<Value>> emplace(Key key, Args &&...args)
+		{
+			auto [result, inserted] = try_emplace(std::move(key), std::forward<Args>(args)...);
+			if(!inserted)
+				return std::nullopt;
+			return result;
+		}
+
+		bool contains(const Key &key) const noexcept
+		{
+			return find_slot(key) != lazy_flat_index::npos;
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		bool contains(const K &key) const noexcept
+		{
+			return find_slot(key) != lazy_flat_index::npos;
+		}
+
+		Value &operator[](const Key &key)
+		{
+			return at(key);
+		}
+
+		Value &at(const Key &key)
+		{
+			return values_[checked_slot(key)];
+		}
+
+		const Value &at(const Key &key) const
+		{
+			return values_[checked_slot(key)];
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		Value &at(const K &key)
+		{
+			return values_[checked_slot(key)];
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		const Value &at(const K &key) const
+		{
+			return values_[checked_slot(key)];
+		}
+
+		std::size_t size() const noexcept
+		{
+			return index_table.size();
+		}
+
+		std::size_t allocated_size() const noexcept
+		{
+			return keys_.size();
+		}
+
+		/*
+		bytes held by the table's own arrays,
+		memory owned by keys and values themselves is not included.
+		*/
+		std::size_t allocated_bytes() const noexcept
+		{
+			return keys_.capacity() * sizeof(Key) + values_.capacity() * sizeof(Value) +
+			       removed_slots.allocated_bytes() + index_table.allocated_bytes();
+		}
+
+		bool empty() const noexcept
+		{
+			return index_table.empty();
+		}
+
+		bool allocated_empty() const noexcept
+		{
+			return index_table.empty() && keys_.empty();
+		}
+
+		/*
+		keeps the order of live slots, moves them in place.
+		*/
+		void force_compact() noexcept
+		{
+			std::size_t live = 0;
+			removed_slots.for_each_clear(keys_.size(), [this, &live](std::size_t slot) {
+				if(slot != live)
+				{
+					keys_[live] = std::move(keys_[slot]);
+					values_[live] = std::move(values_[slot]);
+				}
+				++live;
+			});
+			keys_.resize(live);
+			values_.resize(live);
+			removed_slots.clear();
+			removed_slots.resize(live);
+			/*
+			rebuild index
+			*/
+			index_table.clear();
+			for(std::size_t i = 0; i < live; ++i)
+			{
+				std::size_t hash = hash_of(keys_[i]);
+				auto [pos, found] = index_table.find_or_prepare_insert(hash, no_match, slot_hasher());
+				index_table.insert_at(pos, hash, i);
+			}
+		}
+
+		void compact() noexcept
+		{
+			while(!removed_slots.empty() && !keys_.empty() && removed_slots.test(keys_.size() - 1))
+			{
+				removed_slots.reset(keys_.size() - 1);
+				keys_.pop_back();
+				values_.pop_back();
+			}
+			removed_slots.resize(keys_.size());
+			if(removed_slots.count() > keys_.size() / 2)
+			{
+				force_compact();
+			}
+		}
+
+		void reserve(std::size_t size)
+		{
+			keys_.reserve(size);
+			values_.reserve(size);
+			index_table.reserve(size, slot_hasher());
+		}
+
+		/*
+		returns true as the variable exists
+		*/
+		bool lazy_remove(const Key &key)
+		{
+			return lazy_remove_impl(key);
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		bool lazy_remove(const K &key)
+		{
+			return lazy_remove_impl(key);
+		}
+
+		void remove(const Key &key)
+		{
+			if(lazy_remove(key))
+				compact();
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		void remove(const K &key)
+		{
+			if(lazy_remove(key))
+				compact();
+		}
+
+		void clear()
+		{
+			removed_slots.clear();
+			index_table.clear();
+			keys_.clear();
+			values_.clear();
+		}
+
+		/*
+		raw columns, indexed by slot, removed slots included.
+		use is_removed or the for_each family to skip them.
+		*/
+		std::span<const Key> keys() const noexcept { return keys_; }
+		std::span<Value> values() noexcept { return values_; }
+		std::span<const Value> values() const noexcept { return values_; }
+
+		bool is_removed(std::size_t slot) const noexcept { return removed_slots.test(slot); }
+
+		/*
+		fn(const Key &, Value &) for every live slot
+		*/
+		template<typename Fn>
+		void for_each(Fn &&fn)
+		{
+			removed_slots.for_each_clear(keys_.size(), [this, &fn](std::size_t slot) { fn(keys_[slot], values_[slot]); });
+		}
+
+		template<typename Fn>
+		void for_each(Fn &&fn) const
+		{
+			removed_slots.for_each_clear(keys_.size(), [this, &fn](std::size_t slot) { fn(keys_[slot], values_[slot]); });
+		}
+
+		/*
+		fn(Value &) for every live slot, the key column is never touched.
+		*/
+		template<typename Fn>
+		void for_each_value(Fn &&fn)
+		{
+			removed_slots.for_each_clear(values_.size(), [this, &fn](std::size_t slot) { fn(values_[slot]); });
+		}
+
+		template<typename Fn>
+		void for_each_value(Fn &&fn) const
+		{
+			removed_slots.for_each_clear(values_.size(), [this, &fn](std::size_t slot) { fn(values_[slot]); });
+		}
+
+		/*
+		fn(const Key &) for every live slot, the value column is never touched.
+		*/
+		template<typename Fn>
+		void for_each_key(Fn &&fn) const
+		{
+			removed_slots.for_each_clear(keys_.size(), [this, &fn](std::size_t slot) { fn(keys_[slot]); });
+		}
+
+	private:
+		static constexpr bool no_match(std::size_t) noexcept { return false; }
+
+		template<typename K>
+		std::size_t hash_of(const K &key) const noexcept
+		{
+			return lazy_flat_index::mix(hasher(key));
+		}
+
+		template<typename K>
+		auto key_matcher(const K &key) const noexcept
+		{
+			return [this, &key](std::size_t slot) { return key_equal(keys_[slot], key); };
+		}
+
+		auto slot_hasher() const noexcept
+		{
+			return [this](std::size_t slot) { return hash_of(keys_[slot]); };
+		}
+
+		template<typename K>
+		std::size_t find_slot(const K &key) const noexcept
+		{
+			std::size_t pos = index_table.find(hash_of(key), key_matcher(key));
+			return pos == lazy_flat_index::npos ? pos : index_table.slot(pos);
+		}
+
+		template<typename K>
+		std::size_t checked_slot(const K &key) const
+		{
+			std::size_t slot = find_slot(key);
+			if(slot == lazy_flat_index::npos)
+				throw std::out_of_range("Key not found");
+			return slot;
+		}
+
+		template<typename K>
+		bool lazy_remove_impl(const K &key)
+		{
+			std::size_t pos = index_table.find(hash_of(key), key_matcher(key));
+			if(pos == lazy_flat_index::npos)
+				return false;
+			std::size_t slot = index_table.slot(pos);
+			values_[slot] = Value{};
+			removed_slots.set(slot);
+			index_table.erase_at(pos);
+			return true;
+		}
+
+		basic_lazy_slot_bitmap<Allocator> removed_slots;
+		std::vector<Key, rebind_alloc<Key>> keys_;
+		std::vector<Value, rebind_alloc<Value>> values_;
+		basic_lazy_flat_index<Allocator> index_table;
+		[[no_unique_address]] Hash hasher;
+		[[no_unique_address]] KeyEqual key_equal;
+	};
+
+	namespace pmr
+	{
+		template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+		using lazy_flat_table = libsugarx::lazy_flat_table<Key, Value, Hash, KeyEqual, std::pmr::polymorphic_allocator<std::byte>>;
+
+		template<typename Key, std::default_initializable Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+		using lazy_soa_table = libsugarx::lazy_soa_table<Key, Value, Hash, KeyEqual, std::pmr::polymorphic_allocator<std::byte>>;
+	} // namespace pmr
 }; // namespace libsugarx
 
 namespace std
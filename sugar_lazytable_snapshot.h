@@ -0,0 +1,540 @@
+#ifndef LIBSUGARX_LAZYTABLE_SNAPSHOT_H
+#define LIBSUGARX_LAZYTABLE_SNAPSHOT_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "sugar_endian.h"
+#include "sugar_lazytable.h"
+#include "sugar_types.h"
+
+/*
+snapshot image of a lazy_flat_table with trivially copyable keys and values:
+
+header | keys[count] | values[count] | controls[capacity] | slots[capacity]
+
+every section starts on a 64 byte boundary.
+header fields and slots are little-endian, keys and values keep the writer's
+byte order, which is recorded in the header and checked on load.
+the index is stored as built, so Hash must give the same values in the
+writing and the reading process.
+*/
+
+namespace libsugarx
+{
+	enum class snapshot_error : uint8_t
+	{
+		none = 0U,
+		io,
+		magic,
+		version,
+		byte_order,
+		layout,
+		truncated,
+		corrupt_index,
+	};
+
+	template<typename Key, typename Value>
+	concept snapshot_entry = std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>;
+
+	struct lazy_snapshot_header
+	{
+		static constexpr std::array<char, 8> expected_magic{'S', 'G', 'X', 'L', 'F', 'T', '\0', '\0'};
+		static constexpr std::uint32_t current_version = 1;
+		static constexpr std::uint32_t little_order = 1;
+		static constexpr std::uint32_t big_order = 2;
+		static constexpr std::size_t section_align = 64;
+		static constexpr std::size_t encoded_size = 8 + 6 * 4 + 7 * 8;
+
+		std::array<char, 8> magic = expected_magic;
+		std::uint32_t version = current_version;
+		std::uint32_t byte_order = is_little_endian() ? little_order : big_order;
+		std::uint32_t key_size = 0;
+		std::uint32_t key_align = 0;
+		std::uint32_t value_size = 0;
+		std::uint32_t value_align = 0;
+		std::uint64_t count = 0;
+		std::uint64_t capacity = 0;
+		std::uint64_t keys_offset = 0;
+		std::uint64_t values_offset = 0;
+		std::uint64_t controls_offset = 0;
+		std::uint64_t slots_offset = 0;
+		std::uint64_t total_size = 0;
+
+		static constexpr std::uint64_t align_up(std::uint64_t offset) noexcept
+		{
+			return (offset + section_align - 1) / section_align * section_align;
+		}
+
+		template<typename Key, typename Value>
+		void set_layout(std::uint64_t entries, std::uint64_t index_capacity) noexcept
+		{
+			key_size = sizeof(Key);
+			key_align = alignof(Key);
+			value_size = sizeof(Value);
+			value_align = alignof(Value);
+			count = entries;
+			capacity = index_capacity;
+			keys_offset = align_up(encoded_size);
+			values_offset = align_up(keys_offset + count * key_size);
+			controls_offset = align_up(values_offset + count * value_size);
+			slots_offset = align_up(controls_offset + capacity);
+			total_size = slots_offset + capacity * sizeof(std::uint64_t);
+		}
+
+		std::array<std::byte, encoded_size> encode() const noexcept
+		{
+			std::array<std::byte, encoded_size> result{};
+			std::byte *out = result.data();
+			std::memcpy(out, magic.data(), magic.size());
+			out += magic.size();
+			for(std::uint32_t field : {version, byte_order, key_size, key_align, value_size, value_align})
+			{
+				field = to_little_endian(field);
+				std::memcpy(out, &field, sizeof(field));
+				out += sizeof(field);
+			}
+			for(std::uint64_t field : {count, capacity, keys_offset, values_offset, controls_offset, slots_offset, total_size})
+			{
+				field = to_little_endian(field);
+				std::memcpy(out, &field, sizeof(field));
+				out += sizeof(field);
+			}
+			return result;
+		}
+
+		// return snapshot_error::none on success
+		snapshot_error decode(const_data_span image) noexcept
+		{
+			if(image.size() < encoded_size)
+				return snapshot_error::truncated;
+			const std::byte *in = image.data();
+			std::memcpy(magic.data(), in, magic.size());
+			in += magic.size();
+			for(std::uint32_t *field : {&version, &byte_order, &key_size, &key_align, &value_size, &value_align})
+			{
+				std::memcpy(field, in, sizeof(*field));
+				*field = to_little_endian(*field);
+				in += sizeof(*field);
+			}
+			for(std::uint64_t *field : {&count, &capacity, &keys_offset, &values_offset, &controls_offset, &slots_offset, &total_size})
+			{
+				std::memcpy(field, in, sizeof(*field));
+				*field = to_little_endian(*field);
+				in += sizeof(*field);
+			}
+
+			if(magic != expected_magic)
+				return snapshot_error::magic;
+			if(version != current_version)
+				return snapshot_error::version;
+			if(byte_order != (is_little_endian() ? little_order : big_order))
+				return snapshot_error::byte_order;
+			if(total_size > image.size())
+				return snapshot_error::truncated;
+			return snapshot_error::none;
+		}
+
+		// the layout a reader for Key/Value expects, so offsets can be trusted
+		template<typename Key, typename Value>
+		bool matches() const noexcept
+		{
+			lazy_snapshot_header expected;
+			expected.set_layout<Key, Value>(count, capacity);
+			return key_size == expected.key_size && key_align == expected.key_align &&
+			       value_size == expected.value_size && value_align == expected.value_align &&
+			       keys_offset == expected.keys_offset && values_offset == expected.values_offset &&
+			       controls_offset == expected.controls_offset && slots_offset == expected.slots_offset &&
+			       total_size == expected.total_size && count <= capacity &&
+			       (capacity == 0 || (std::has_single_bit(capacity) && capacity >= lazy_flat_index::group_width));
+		}
+	};
+
+	/*
+	class lazy_flat_table_view
+	read-only lookups straight on a snapshot image, no per-entry work on open.
+	the image must stay alive and 64 byte aligned while the view is used.
+	*/
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	requires snapshot_entry<Key, Value>
+	class lazy_flat_table_view
+	{
+		const Key *keys_ = nullptr;
+		const Value *values_ = nullptr;
+		const std::uint8_t *controls_ = nullptr;
+		const std::byte *slots_ = nullptr;
+		std::size_t count_ = 0;
+		std::size_t capacity_ = 0;
+		[[no_unique_address]] Hash hasher;
+		[[no_unique_address]] KeyEqual key_equal;
+
+		std::size_t slot_at(std::size_t pos) const noexcept
+		{
+			std::uint64_t slot;
+			std::memcpy(&slot, slots_ + pos * sizeof(slot), sizeof(slot));
+			return static_cast<std::size_t>(to_little_endian(slot));
+		}
+
+		template<typename K>
+		const Value *find_impl(const K &key) const noexcept
+		{
+			std::size_t pos = lazy_flat_index::find_in(
+				controls_, capacity_, lazy_flat_index::mix(hasher(key)),
+				[this](std::size_t at) { return slot_at(at); },
+				[this, &key](std::size_t slot) { return slot < count_ && key_equal(keys_[slot], key); });
+			return pos == lazy_flat_index::npos ? nullptr : values_ + slot_at(pos);
+		}
+
+		template<typename K>
+		const Value &checked_find(const K &key) const
+		{
+			const Value *value = find_impl(key);
+			if(!value)
+				throw std::out_of_range("Key not found");
+			return *value;
+		}
+
+	public:
+		// return snapshot_error::none on success
+		snapshot_error assign(const_data_span image) noexcept
+		{
+			lazy_snapshot_header header;
+			if(snapshot_error error = header.decode(image); error != snapshot_error::none)
+				return error;
+			if(!header.matches<Key, Value>())
+				return snapshot_error::layout;
+
+			keys_ = reinterpret_cast<const Key *>(image.data() + header.keys_offset);
+			values_ = reinterpret_cast<const Value *>(image.data() + header.values_offset);
+			controls_ = reinterpret_cast<const std::uint8_t *>(image.data() + header.controls_offset);
+			slots_ = image.data() + header.slots_offset;
+			count_ = header.count;
+			capacity_ = header.capacity;
+			return snapshot_error::none;
+		}
+
+		std::size_t size() const noexcept { return count_; }
+		bool empty() const noexcept { return count_ == 0; }
+
+		std::span<const Key> keys() const noexcept { return {keys_, count_}; }
+		std::span<const Value> values() const noexcept { return {values_, count_}; }
+
+		/*
+		returns nullptr if key doesn't exist.
+		*/
+		const Value *find(const Key &key) const noexcept
+		{
+			return find_impl(key);
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		const Value *find(const K &key) const noexcept
+		{
+			return find_impl(key);
+		}
+
+		bool contains(const Key &key) const noexcept
+		{
+			return find_impl(key) != nullptr;
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		bool contains(const K &key) const noexcept
+		{
+			return find_impl(key) != nullptr;
+		}
+
+		const Value &at(const Key &key) const
+		{
+			return checked_find(key);
+		}
+
+		template<typename K>
+		requires lazy_transparent_lookup<Hash, KeyEqual>
+		const Value &at(const K &key) const
+		{
+			return checked_find(key);
+		}
+
+		/*
+		fn(const Key &, const Value &) for every entry
+		*/
+		template<typename Fn>
+		void for_each(Fn &&fn) const
+		{
+			for(std::size_t i = 0; i < count_; ++i)
+				fn(keys_[i], values_[i]);
+		}
+
+		/*
+		copies the image into a mutable table, the index is reused as is.
+		every indexed slot is checked against the entry count first,
+		the table is left untouched when the index doesn't fit the entries.
+		return snapshot_error::none on success
+		*/
+		template<typename Allocator>
+		snapshot_error copy_to(lazy_flat_table<Key, Value, Hash, KeyEqual, Allocator> &table) const
+		{
+			typename lazy_flat_table<Key, Value, Hash, KeyEqual, Allocator>::index_type index(table.get_allocator());
+			if(!index.assign(std::span<const std::uint8_t>(controls_, capacity_), [this](std::size_t pos) { return slot_at(pos); }, count_))
+				return snapshot_error::corrupt_index;
+			table.assign_indexed(keys(), values(), std::move(index));
+			return snapshot_error::none;
+		}
+	};
+
+	/*
+	class mapped_file
+	read-only memory mapping of a whole file.
+	*/
+	class mapped_file
+	{
+		const std::byte *data_ = nullptr;
+		std::size_t size_ = 0;
+#ifdef _WIN32
+		HANDLE file_ = INVALID_HANDLE_VALUE;
+		HANDLE mapping_ = nullptr;
+#endif
+
+	public:
+		mapped_file() noexcept = default;
+		~mapped_file() noexcept { close(); }
+
+		mapped_file(const mapped_file &other) = delete;
+		mapped_file &operator=(const mapped_file &other) = delete;
+
+		mapped_file(mapped_file &&other) noexcept { swap(other); }
+		mapped_file &operator=(mapped_file &&other) noexcept
+		{
+			if(this != &other)
+			{
+				close();
+				swap(other);
+			}
+			return *this;
+		}
+
+		void swap(mapped_file &other) noexcept
+		{
+			std::swap(data_, other.data_);
+			std::swap(size_, other.size_);
+#ifdef _WIN32
+			std::swap(file_, other.file_);
+			std::swap(mapping_, other.mapping_);
+#endif
+		}
+
+		/*
+		return true on success
+		*/
+		bool open(const std::filesystem::path &path) noexcept
+		{
+			close();
+#ifdef _WIN32
+			file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if(file_ == INVALID_HANDLE_VALUE)
+				return false;
+			LARGE_INTEGER file_size;
+			if(!GetFileSizeEx(file_, &file_size) || file_size.QuadPart == 0)
+			{
+				close();
+				return false;
+			}
+			mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if(!mapping_)
+			{
+				close();
+				return false;
+			}
+			void *view = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+			if(!view)
+			{
+				close();
+				return false;
+			}
+			data_ = static_cast<const std::byte *>(view);
+			size_ = static_cast<std::size_t>(file_size.QuadPart);
+#else
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if(fd < 0)
+				return false;
+			struct stat info;
+			if(fstat(fd, &info) != 0 || info.st_size == 0)
+			{
+				::close(fd);
+				return false;
+			}
+			void *view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd);
+			if(view == MAP_FAILED)
+				return false;
+			data_ = static_cast<const std::byte *>(view);
+			size_ = static_cast<std::size_t>(info.st_size);
+#endif
+			return true;
+		}
+
+		void close() noexcept
+		{
+#ifdef _WIN32
+			if(data_)
+				UnmapViewOfFile(data_);
+			if(mapping_)
+				CloseHandle(mapping_);
+			if(file_ != INVALID_HANDLE_VALUE)
+				CloseHandle(file_);
+			mapping_ = nullptr;
+			file_ = INVALID_HANDLE_VALUE;
+#else
+			if(data_)
+				munmap(const_cast<std::byte *>(data_), size_);
+#endif
+			data_ = nullptr;
+			size_ = 0;
+		}
+
+		const_data_span data() const noexcept { return {data_, size_}; }
+		bool is_open() const noexcept { return data_ != nullptr; }
+	};
+
+	/*
+	class lazy_flat_snapshot
+	a mapped snapshot file plus a view on it.
+	*/
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	requires snapshot_entry<Key, Value>
+	class lazy_flat_snapshot
+	{
+		mapped_file file_;
+		lazy_flat_table_view<Key, Value, Hash, KeyEqual> view_;
+
+	public:
+		// return snapshot_error::none on success
+		snapshot_error open(const std::filesystem::path &path) noexcept
+		{
+			view_ = {};
+			if(!file_.open(path))
+				return snapshot_error::io;
+			snapshot_error error = view_.assign(file_.data());
+			if(error != snapshot_error::none)
+			{
+				file_.close();
+				view_ = {};
+			}
+			return error;
+		}
+
+		const lazy_flat_table_view<Key, Value, Hash, KeyEqual> &view() const noexcept { return view_; }
+	};
+
+	template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+	requires snapshot_entry<Key, Value>
+	/*
+	writes the live entries densely, in iteration order,
+	with an index built over the dense positions.
+	return snapshot_error::none on success
+	*/
+	snapshot_error write_snapshot(const lazy_flat_table<Key, Value, Hash, KeyEqual, Allocator> &table, std::ostream &out)
+	{
+		Hash hasher;
+		std::vector<std::size_t> hashes;
+		hashes.reserve(table.size());
+		for(auto iter = table.cbegin(); iter != table.cend(); ++iter)
+			hashes.push_back(lazy_flat_index::mix(hasher((*iter).key())));
+
+		auto hash_of = [&hashes](std::size_t slot) { return hashes[slot]; };
+		lazy_flat_index index;
+		index.reserve(hashes.size(), hash_of);
+		for(std::size_t i = 0; i < hashes.size(); ++i)
+		{
+			auto [pos, found] = index.find_or_prepare_insert(hashes[i], [](std::size_t) { return false; }, hash_of);
+			index.insert_at(pos, hashes[i], i);
+		}
+
+		lazy_snapshot_header header;
+		header.set_layout<Key, Value>(hashes.size(), index.capacity());
+
+		std::uint64_t written = 0;
+		auto pad_to = [&out, &written](std::uint64_t offset) {
+			static constexpr std::array<char, lazy_snapshot_header::section_align> zeros{};
+			out.write(zeros.data(), static_cast<std::streamsize>(offset - written));
+			written = offset;
+		};
+		auto write = [&out, &written](const void *data, std::size_t size) {
+			out.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+			written += size;
+		};
+
+		auto encoded = header.encode();
+		write(encoded.data(), encoded.size());
+		pad_to(header.keys_offset);
+		for(auto iter = table.cbegin(); iter != table.cend(); ++iter)
+			write(&(*iter).key(), sizeof(Key));
+		pad_to(header.values_offset);
+		for(auto iter = table.cbegin(); iter != table.cend(); ++iter)
+			write(&(*iter).value(), sizeof(Value));
+		pad_to(header.controls_offset);
+		write(index.controls().data(), index.controls().size());
+		pad_to(header.slots_offset);
+		for(std::size_t pos = 0; pos < index.capacity(); ++pos)
+		{
+			std::uint64_t slot = lazy_flat_index::is_full(index.controls()[pos]) ? index.slot(pos) : 0;
+			slot = to_little_endian(slot);
+			write(&slot, sizeof(slot));
+		}
+
+		return out ? snapshot_error::none : snapshot_error::io;
+	}
+
+	template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+	requires snapshot_entry<Key, Value>
+	snapshot_error write_snapshot(const lazy_flat_table<Key, Value, Hash, KeyEqual, Allocator> &table, const std::filesystem::path &path)
+	{
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		if(!out)
+			return snapshot_error::io;
+		return write_snapshot(table, out);
+	}
+
+	template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+	requires snapshot_entry<Key, Value>
+	/*
+	loads a snapshot file into a mutable table with one pass over the mapped arrays.
+	return snapshot_error::none on success
+	*/
+	snapshot_error load_snapshot(const std::filesystem::path &path, lazy_flat_table<Key, Value, Hash, KeyEqual, Allocator> &table)
+	{
+		lazy_flat_snapshot<Key, Value, Hash, KeyEqual> snapshot;
+		if(snapshot_error error = snapshot.open(path); error != snapshot_error::none)
+			return error;
+		return snapshot.view().copy_to(table);
+	}
+} // namespace libsugarx
+
+#endif // LIBSUGARX_LAZYTABLE_SNAPSHOT_H
@@ -1,11 +1,39 @@
 #ifndef LIBSUGARX_STRING_H
 #define LIBSUGARX_STRING_H
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
 #include <format>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <ranges>
+#include <span>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LIBSUGARX_HAS_AVX2 1
+#define LIBSUGARX_HAS_SSSE3 1
+#define LIBSUGARX_HAS_SSE2 1
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define LIBSUGARX_HAS_SSSE3 1
+#define LIBSUGARX_HAS_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LIBSUGARX_HAS_SSE2 1
+#endif
+
+#include "sugar_endian.h"
 #include "sugar_types.h"
 
 namespace libsugarx
@@ -30,7 +58,7 @@ namespace libsugarx
 		constexpr value operator()(std::string_view str) const noexcept
 		{
 			std::size_t h = 0xcbf29ce484222325ULL;
-			for(std::size_t i = 0; i < str.length() - 1; ++i)
+			for(std::size_t i = 0; i < str.length(); ++i)
 			{
 				h ^= static_cast<unsigned char>(str[i]);
 				h *= 0x100000001b3ULL;
@@ -39,11 +67,561 @@ namespace libsugarx
 		}
 	};
 
+	/*
+	struct wide_string_hash
+	64-bit string hash taking 32 bytes per step in four 8-byte lanes,
+	shorter tails go 16 and 8 bytes at a time.
+	the SSE2/AVX2 paths and the constexpr scalar path give identical results.
+	transparent, so it can be the hasher of lazy_flat_table<std::string, ...>.
+	*/
+	struct wide_string_hash
+	{
+		using is_transparent = void;
+
+		[[nodiscard]]
+		constexpr std::size_t operator()(std::string_view str) const noexcept
+		{
+			return static_cast<std::size_t>(hash(str));
+		}
+
+		[[nodiscard]]
+		static constexpr std::uint64_t hash(std::string_view str) noexcept
+		{
+			const char *p = str.data();
+			std::size_t len = str.size();
+
+			if(len <= 16)
+			{
+				std::uint64_t a = 0;
+				std::uint64_t b = 0;
+				if(len >= 8)
+				{
+					a = load64(p);
+					b = load64(p + len - 8);
+				}
+				else if(len >= 4)
+				{
+					a = load32(p);
+					b = load32(p + len - 4);
+				}
+				else if(len > 0)
+				{
+					a = (std::uint64_t(byte_at(p, 0)) << 16) | (std::uint64_t(byte_at(p, len >> 1)) << 8) | byte_at(p, len - 1);
+				}
+				return avalanche(mul_fold(a ^ keys[0], b ^ keys[1] ^ len));
+			}
+
+			// keep 1..32 bytes for the tail, so up to 32 bytes never touch the lanes
+			std::size_t stripes = (len - 1) / 32;
+			std::uint64_t h = len * prime1;
+			if(stripes > 0)
+			{
+				std::array<std::uint64_t, 4> acc = {prime1, prime2, prime3, prime1 ^ prime2};
+				if consteval
+				{
+					accumulate_scalar(acc, p, stripes);
+				}
+				else
+				{
+					accumulate(acc, p, stripes);
+				}
+				for(std::size_t i = 0; i < 4; ++i)
+					h = mul_fold(h ^ acc[i], keys[i] ^ prime2);
+			}
+
+			const char *tail = p + stripes * 32;
+			const char *end = p + len;
+			if(end - tail > 16)
+			{
+				h = mul_fold(h ^ load64(tail) ^ keys[0], load64(tail + 8) ^ keys[1]);
+			}
+			// len > 16, so the last 16 bytes are always in range
+			h = mul_fold(h ^ load64(end - 16) ^ keys[2], load64(end - 8) ^ keys[3]);
+			return avalanche(h);
+		}
+
+		// 64x64->128 multiply folded to 64 bits, for hashing fixed-size keys too
+		static constexpr std::uint64_t mul_fold(std::uint64_t a, std::uint64_t b) noexcept
+		{
+#if defined(__SIZEOF_INT128__)
+			unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+			return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+#else
+			std::uint64_t a_lo = a & 0xFFFFFFFFULL, a_hi = a >> 32;
+			std::uint64_t b_lo = b & 0xFFFFFFFFULL, b_hi = b >> 32;
+			std::uint64_t lo_lo = a_lo * b_lo;
+			std::uint64_t hi_lo = a_hi * b_lo;
+			std::uint64_t lo_hi = a_lo * b_hi;
+			std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFULL) + lo_hi;
+			std::uint64_t high = a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+			std::uint64_t low = (cross << 32) | (lo_lo & 0xFFFFFFFFULL);
+			return low ^ high;
+#endif
+		}
+
+	private:
+		static constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+		static constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+		static constexpr std::uint64_t prime3 = 0x165667B19E3779F9ULL;
+		static constexpr std::array<std::uint64_t, 4> keys = {
+			0xBE4BA423396CFEB8ULL,
+			0x1CAD21F72C81017CULL,
+			0xDB979083E96DD4DEULL,
+			0x1F67B3B7A4A44072ULL,
+		};
+
+		static constexpr std::uint64_t byte_at(const char *p, std::size_t i) noexcept
+		{
+			return static_cast<unsigned char>(p[i]);
+		}
+
+		static constexpr std::uint64_t load64(const char *p) noexcept
+		{
+			if consteval
+			{
+				std::uint64_t value = 0;
+				for(std::size_t i = 0; i < 8; ++i)
+					value |= byte_at(p, i) << (8 * i);
+				return value;
+			}
+			else
+			{
+				std::uint64_t value;
+				std::memcpy(&value, p, sizeof(value));
+				return to_little_endian(value);
+			}
+		}
+
+		static constexpr std::uint64_t load32(const char *p) noexcept
+		{
+			if consteval
+			{
+				std::uint64_t value = 0;
+				for(std::size_t i = 0; i < 4; ++i)
+					value |= byte_at(p, i) << (8 * i);
+				return value;
+			}
+			else
+			{
+				std::uint32_t value;
+				std::memcpy(&value, p, sizeof(value));
+				return to_little_endian(value);
+			}
+		}
+
+		static constexpr std::uint64_t avalanche(std::uint64_t h) noexcept
+		{
+			h ^= h >> 33;
+			h *= prime2;
+			h ^= h >> 29;
+			h *= prime3;
+			h ^= h >> 32;
+			return h;
+		}
+
+		/*
+		per lane: acc[i] += lo32(d ^ key) * hi32(d ^ key), acc[i ^ 1] += d.
+		only 32x32->64 multiplies, so the vector paths match it exactly.
+		*/
+		static constexpr void accumulate_scalar(std::array<std::uint64_t, 4> &acc, const char *p, std::size_t stripes) noexcept
+		{
+			for(std::size_t s = 0; s < stripes; ++s, p += 32)
+			{
+				for(std::size_t i = 0; i < 4; ++i)
+				{
+					std::uint64_t data = load64(p + 8 * i);
+					std::uint64_t keyed = data ^ keys[i];
+					acc[i ^ 1] += data;
+					acc[i] += (keyed & 0xFFFFFFFFULL) * (keyed >> 32);
+				}
+			}
+		}
+
+		static void accumulate(std::array<std::uint64_t, 4> &acc, const char *p, std::size_t stripes) noexcept
+		{
+#if defined(LIBSUGARX_HAS_AVX2)
+			__m256i sum = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc.data()));
+			const __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys.data()));
+			for(std::size_t s = 0; s < stripes; ++s, p += 32)
+			{
+				__m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+				__m256i keyed = _mm256_xor_si256(data, key);
+				__m256i product = _mm256_mul_epu32(keyed, _mm256_srli_epi64(keyed, 32));
+				__m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+				sum = _mm256_add_epi64(sum, _mm256_add_epi64(product, swapped));
+			}
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(acc.data()), sum);
+#elif defined(LIBSUGARX_HAS_SSE2)
+			__m128i sum0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc.data()));
+			__m128i sum1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc.data() + 2));
+			const __m128i key0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys.data()));
+			const __m128i key1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys.data() + 2));
+			for(std::size_t s = 0; s < stripes; ++s, p += 32)
+			{
+				__m128i data0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+				__m128i data1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16));
+				__m128i keyed0 = _mm_xor_si128(data0, key0);
+				__m128i keyed1 = _mm_xor_si128(data1, key1);
+				__m128i product0 = _mm_mul_epu32(keyed0, _mm_srli_epi64(keyed0, 32));
+				__m128i product1 = _mm_mul_epu32(keyed1, _mm_srli_epi64(keyed1, 32));
+				sum0 = _mm_add_epi64(sum0, _mm_add_epi64(product0, _mm_shuffle_epi32(data0, _MM_SHUFFLE(1, 0, 3, 2))));
+				sum1 = _mm_add_epi64(sum1, _mm_add_epi64(product1, _mm_shuffle_epi32(data1, _MM_SHUFFLE(1, 0, 3, 2))));
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(acc.data()), sum0);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(acc.data() + 2), sum1);
+#else
+			accumulate_scalar(acc, p, stripes);
+#endif
+		}
+	};
+
+	/*
+	struct utf8
+	validation in the style of simdutf/simdjson (Keiser & Lemire lookup tables):
+	every byte is classified from its own high nibble and the previous byte's nibbles,
+	the error classes of the three lookups are and-ed together, so a block costs a few shuffles.
+	pure ASCII blocks only check that no sequence was left open.
+	SSSE3 checks 16 bytes per step and AVX2 32, the constexpr scalar path gives the same answer.
+	*/
+	struct utf8
+	{
+		[[nodiscard]]
+		static constexpr bool validate(std::string_view str) noexcept
+		{
+			if consteval
+			{
+				return validate_scalar(str);
+			}
+			else
+			{
+#if defined(LIBSUGARX_HAS_AVX2)
+				return validate_avx2(str);
+#elif defined(LIBSUGARX_HAS_SSSE3)
+				return validate_ssse3(str);
+#else
+				return validate_scalar(str);
+#endif
+			}
+		}
+
+		/*
+		length of str without a trailing sequence that was cut short,
+		strings that don't end in a lead byte plus too few continuations are left alone.
+		*/
+		[[nodiscard]]
+		static constexpr std::size_t complete_prefix(std::string_view str) noexcept
+		{
+			std::size_t n = str.size();
+			for(std::size_t back = 1; back <= std::min<std::size_t>(n, 4); ++back)
+			{
+				unsigned char c = static_cast<unsigned char>(str[n - back]);
+				if((c & 0xC0) == 0x80)
+					continue;
+				std::size_t need = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+				return need > back ? n - back : n;
+			}
+			return n;
+		}
+
+		/*
+		the longest prefix of at most max bytes that doesn't split a code point.
+		*/
+		[[nodiscard]]
+		static constexpr std::size_t truncate_length(std::string_view str, std::size_t max) noexcept
+		{
+			if(str.size() <= max)
+				return str.size();
+			return complete_prefix(str.substr(0, max));
+		}
+
+		static constexpr bool validate_scalar(std::string_view str) noexcept
+		{
+			auto continuation = [](unsigned char c) { return (c & 0xC0) == 0x80; };
+			std::size_t n = str.size();
+			for(std::size_t i = 0; i < n;)
+			{
+				unsigned char c = static_cast<unsigned char>(str[i]);
+				if(c < 0x80)
+				{
+					++i;
+					continue;
+				}
+
+				std::size_t length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+				if(c < 0xC2 || c > 0xF4 || n - i < length)
+					return false;
+				unsigned char next = static_cast<unsigned char>(str[i + 1]);
+				if(!continuation(next))
+					return false;
+				// overlong 3/4 byte forms, surrogates and code points above U+10FFFF
+				if((c == 0xE0 && next < 0xA0) || (c == 0xED && next >= 0xA0) || (c == 0xF0 && next < 0x90) || (c == 0xF4 && next >= 0x90))
+					return false;
+				for(std::size_t k = 2; k < length; ++k)
+				{
+					if(!continuation(static_cast<unsigned char>(str[i + k])))
+						return false;
+				}
+				i += length;
+			}
+			return true;
+		}
+
+	private:
+		static constexpr std::uint8_t too_short = 1 << 0;
+		static constexpr std::uint8_t too_long = 1 << 1;
+		static constexpr std::uint8_t overlong_3 = 1 << 2;
+		static constexpr std::uint8_t too_large = 1 << 3;
+		static constexpr std::uint8_t surrogate = 1 << 4;
+		static constexpr std::uint8_t overlong_2 = 1 << 5;
+		static constexpr std::uint8_t too_large_1000 = 1 << 6;
+		static constexpr std::uint8_t overlong_4 = 1 << 6;
+		static constexpr std::uint8_t two_conts = 1 << 7;
+		static constexpr std::uint8_t carry = too_short | too_long | two_conts;
+
+		// indexed by the previous byte's high nibble
+		static constexpr std::array<std::uint8_t, 16> byte_1_high = {
+			too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+			two_conts, two_conts, two_conts, two_conts,
+			too_short | overlong_2,
+			too_short,
+			too_short | overlong_3 | surrogate,
+			too_short | too_large | too_large_1000 | overlong_4,
+		};
+
+		// indexed by the previous byte's low nibble
+		static constexpr std::array<std::uint8_t, 16> byte_1_low = {
+			carry | overlong_3 | overlong_2 | overlong_4,
+			carry | overlong_2,
+			carry,
+			carry,
+			carry | too_large,
+			carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000 | surrogate,
+			carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000,
+		};
+
+		// indexed by the current byte's high nibble
+		static constexpr std::array<std::uint8_t, 16> byte_2_high = {
+			too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+			too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+			too_long | overlong_2 | two_conts | overlong_3 | too_large,
+			too_long | overlong_2 | two_conts | surrogate | too_large,
+			too_long | overlong_2 | two_conts | surrogate | too_large,
+			too_short, too_short, too_short, too_short,
+		};
+
+#if defined(LIBSUGARX_HAS_SSSE3)
+		static bool validate_ssse3(std::string_view str) noexcept
+		{
+			const __m128i table_1_high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(byte_1_high.data()));
+			const __m128i table_1_low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(byte_1_low.data()));
+			const __m128i table_2_high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(byte_2_high.data()));
+			const __m128i nibble = _mm_set1_epi8(0x0F);
+			// a lead byte in the last 1..3 positions needs the next block
+			const __m128i max_tail = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+
+			__m128i error = _mm_setzero_si128();
+			__m128i previous = _mm_setzero_si128();
+			__m128i previous_incomplete = _mm_setzero_si128();
+
+			auto check = [&](__m128i input) {
+				if(_mm_movemask_epi8(input) == 0)
+				{
+					error = _mm_or_si128(error, previous_incomplete);
+					previous = input;
+					return;
+				}
+				__m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+				__m128i special = _mm_and_si128(
+					_mm_and_si128(_mm_shuffle_epi8(table_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+						_mm_shuffle_epi8(table_1_low, _mm_and_si128(prev1, nibble))),
+					_mm_shuffle_epi8(table_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+				__m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+				__m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+				__m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+				__m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+				__m128i must_continue = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+				error = _mm_or_si128(error, _mm_xor_si128(must_continue, special));
+				previous_incomplete = _mm_subs_epu8(input, max_tail);
+				previous = input;
+			};
+
+			const char *p = str.data();
+			std::size_t n = str.size();
+			std::size_t i = 0;
+			for(; i + 16 <= n; i += 16)
+				check(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i)));
+			if(i < n)
+			{
+				// zero padding reads as ASCII, so an open sequence still fails
+				alignas(16) std::array<char, 16> tail{};
+				std::memcpy(tail.data(), p + i, n - i);
+				check(_mm_load_si128(reinterpret_cast<const __m128i *>(tail.data())));
+			}
+			error = _mm_or_si128(error, previous_incomplete);
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+		}
+#endif
+
+#if defined(LIBSUGARX_HAS_AVX2)
+		static bool validate_avx2(std::string_view str) noexcept
+		{
+			const __m256i table_1_high = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(byte_1_high.data())));
+			const __m256i table_1_low = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(byte_1_low.data())));
+			const __m256i table_2_high = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(byte_2_high.data())));
+			const __m256i nibble = _mm256_set1_epi8(0x0F);
+			const __m256i max_tail = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+
+			__m256i error = _mm256_setzero_si256();
+			__m256i previous = _mm256_setzero_si256();
+			__m256i previous_incomplete = _mm256_setzero_si256();
+
+			auto check = [&](__m256i input) {
+				if(_mm256_movemask_epi8(input) == 0)
+				{
+					error = _mm256_or_si256(error, previous_incomplete);
+					previous = input;
+					return;
+				}
+				// alignr works per 128-bit lane, shift in the high lane of previous first
+				__m256i carried = _mm256_permute2x128_si256(previous, input, 0x21);
+				__m256i prev1 = _mm256_alignr_epi8(input, carried, 15);
+				__m256i special = _mm256_and_si256(
+					_mm256_and_si256(_mm256_shuffle_epi8(table_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+						_mm256_shuffle_epi8(table_1_low, _mm256_and_si256(prev1, nibble))),
+					_mm256_shuffle_epi8(table_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+				__m256i prev2 = _mm256_alignr_epi8(input, carried, 14);
+				__m256i prev3 = _mm256_alignr_epi8(input, carried, 13);
+				__m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+				__m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+				__m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+				error = _mm256_or_si256(error, _mm256_xor_si256(must_continue, special));
+				previous_incomplete = _mm256_subs_epu8(input, max_tail);
+				previous = input;
+			};
+
+			const char *p = str.data();
+			std::size_t n = str.size();
+			std::size_t i = 0;
+			for(; i + 32 <= n; i += 32)
+				check(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i)));
+			if(i < n)
+			{
+				alignas(32) std::array<char, 32> tail{};
+				std::memcpy(tail.data(), p + i, n - i);
+				check(_mm256_load_si256(reinterpret_cast<const __m256i *>(tail.data())));
+			}
+			error = _mm256_or_si256(error, previous_incomplete);
+			return _mm256_testz_si256(error, error) != 0;
+		}
+#endif
+	};
+
+	/*
+	class utf8_string
+	fixed_string<N> that always holds valid UTF-8.
+	text is validated once on the way in and truncated on code point boundaries,
+	appending another utf8_string skips validation, so checked text is never scanned again.
+	*/
+	template<std::size_t N>
+	class utf8_string
+	{
+		fixed_string<N> str_;
+
+	public:
+		constexpr utf8_string() noexcept = default;
+
+		[[nodiscard]]
+		static constexpr std::optional<utf8_string> from(std::string_view text) noexcept
+		{
+			utf8_string result;
+			if(!result.copy(text))
+				return std::nullopt;
+			return result;
+		}
+
+		/*
+		returns false and leaves the string unchanged if text isn't valid UTF-8.
+		*/
+		constexpr bool copy(std::string_view text) noexcept
+		{
+			if(!utf8::validate(text))
+				return false;
+			str_.copy(text);
+			return true;
+		}
+
+		constexpr bool concat(std::string_view text) noexcept
+		{
+			if(!utf8::validate(text))
+				return false;
+			str_.concat(text);
+			return true;
+		}
+
+		template<std::size_t M>
+		constexpr void concat(const utf8_string<M> &text) noexcept
+		{
+			str_.concat(text.view());
+		}
+
+		constexpr const fixed_string<N> &str() const noexcept { return str_; }
+		constexpr const char *data() const noexcept { return str_.data(); }
+		constexpr std::size_t length() const noexcept { return str_.length(); }
+		constexpr bool empty() const noexcept { return str_.empty(); }
+		constexpr void clear() noexcept { str_.clear(); }
+		constexpr std::string_view view() const noexcept { return str_.view(); }
+		constexpr operator std::string_view() const noexcept { return view(); }
+
+		template<std::size_t M>
+		constexpr bool operator==(const utf8_string<M> &other) const noexcept { return view() == other.view(); }
+		constexpr bool operator==(std::string_view other) const noexcept { return view() == other; }
+	};
+
+	/*
+	struct format_result
+	size is the length the whole output would have,
+	truncated is set when it didn't fit and was cut.
+	converts to true when nothing was cut, so callers expecting a bool keep compiling.
+	*/
+	struct format_result
+	{
+		std::size_t size = 0;
+		bool truncated = false;
+
+		constexpr operator bool() const noexcept { return !truncated; }
+	};
+
+	/*
+	format strings only known at runtime, string literals are left to the
+	std::format_string overloads so they keep their compile-time check.
+	*/
+	template<typename T>
+	concept runtime_format_string = std::convertible_to<const T &, std::string_view> && !std::is_array_v<T>;
+
+	/*
+	class bounded_buffer_iterator
+	output iterator for runtime format strings (fixed_string::format),
+	drops what doesn't fit and remembers that it did.
+	*/
 	template<std::size_t N>
 	class bounded_buffer_iterator
 	{
 		char *ptr_;
 		std::size_t remaining_;
+		std::size_t size_ = 0;
+		bool truncated_ = false;
 
 	public:
 		using iterator_category = std::output_iterator_tag;
@@ -57,13 +635,19 @@ namespace libsugarx
 			static_assert(N > 0, "the size of buffer iterator should be greater than 0.");
 		}
 
+		// room for capacity chars, no terminator is written
+		constexpr bounded_buffer_iterator(char *buffer, std::size_t capacity) : ptr_(buffer), remaining_(capacity) {}
+
 		constexpr bounded_buffer_iterator &operator=(char c)
 		{
+			++size_;
 			if(remaining_ > 0)
 			{
 				*ptr_++ = c;
 				--remaining_;
 			}
+			else
+				truncated_ = true;
 			return *this;
 		}
 
@@ -72,11 +656,14 @@ namespace libsugarx
 		constexpr bounded_buffer_iterator operator++(int) { return *this; }
 
 		constexpr char *end_ptr() const { return ptr_; }
+		constexpr bool truncated() const { return truncated_; }
+		// chars the whole output has, dropped ones included
+		constexpr std::size_t size() const { return size_; }
 	};
 
 	template<std::size_t N, typename... Args>
 	[[nodiscard]]
-	static constexpr fixed_string<N> string_format(std::string_view fmt, Args &&...args)
+	static constexpr fixed_string<N> string_format(std::format_string<Args...> fmt, Args &&...args)
 	{
 		fixed_string<N> buffer;
 		buffer.format(fmt, std::forward<Args>(args)...);
@@ -84,13 +671,473 @@ namespace libsugarx
 		return buffer;
 	}
 
+	template<std::size_t N, typename Fmt, typename... Args>
+	requires runtime_format_string<Fmt>
+	[[nodiscard]]
+	static constexpr fixed_string<N> string_format(const Fmt &fmt, Args &&...args)
+	{
+		fixed_string<N> buffer;
+		buffer.format(fmt, std::forward<Args>(args)...);
+
+		return buffer;
+	}
+
+	enum class hex_error : std::uint8_t
+	{
+		none = 0U,
+		length,
+		invalid_char,
+	};
+
+	/*
+	struct hex_codec
+	lowercase hex encoding, decoding takes either case.
+	SSSE3 handles 16 bytes per step and AVX2 32, with a constexpr scalar path for the rest.
+	*/
+	struct hex_codec
+	{
+		static constexpr std::string_view digits = "0123456789abcdef";
+
+		/*
+		writes 2 chars per byte, as many bytes as fit in out.
+		returns the number of chars written.
+		*/
+		static constexpr std::size_t encode(const_data_span bytes, std::span<char> out) noexcept
+		{
+			std::size_t count = std::min(bytes.size(), out.size() / 2);
+			std::size_t i = 0;
+			if !consteval
+			{
+				i = encode_simd(bytes.data(), count, out.data());
+			}
+			for(; i < count; ++i)
+			{
+				unsigned char c = static_cast<unsigned char>(bytes[i]);
+				out[2 * i] = digits[c >> 4];
+				out[2 * i + 1] = digits[c & 0x0F];
+			}
+			return 2 * count;
+		}
+
+		/*
+		reads hex.size() / 2 bytes into out.
+		on invalid_char, out may be partly written.
+		*/
+		static constexpr hex_error decode(std::string_view hex, data_span out) noexcept
+		{
+			if(hex.size() % 2 != 0 || out.size() < hex.size() / 2)
+				return hex_error::length;
+
+			std::size_t count = hex.size() / 2;
+			std::size_t i = 0;
+			if !consteval
+			{
+				i = decode_simd(hex.data(), count, out.data());
+				if(i == npos)
+					return hex_error::invalid_char;
+			}
+			// table lookups and one check at the end, digits vs letters don't branch
+			int invalid = 0;
+			for(; i < count; ++i)
+			{
+				int hi = nibbles[static_cast<unsigned char>(hex[2 * i])];
+				int lo = nibbles[static_cast<unsigned char>(hex[2 * i + 1])];
+				invalid |= hi | lo;
+				out[i] = static_cast<std::byte>(((hi & 0x0F) << 4) | (lo & 0x0F));
+			}
+			return invalid < 0 ? hex_error::invalid_char : hex_error::none;
+		}
+
+		static constexpr int nibble(char c) noexcept
+		{
+			return nibbles[static_cast<unsigned char>(c)];
+		}
+
+	private:
+		static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+		// hex digit value per char, -1 for the rest
+		static constexpr std::array<std::int8_t, 256> nibbles = [] {
+			std::array<std::int8_t, 256> table{};
+			for(int c = 0; c < 256; ++c)
+			{
+				if(c >= '0' && c <= '9')
+					table[c] = static_cast<std::int8_t>(c - '0');
+				else if((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+					table[c] = static_cast<std::int8_t>((c | 0x20) - 'a' + 10);
+				else
+					table[c] = -1;
+			}
+			return table;
+		}();
+
+		// returns how many bytes were encoded
+		static std::size_t encode_simd(const std::byte *in, std::size_t count, char *out) noexcept
+		{
+			std::size_t i = 0;
+#if defined(LIBSUGARX_HAS_AVX2)
+			const __m256i lut = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+				'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+			const __m256i mask = _mm256_set1_epi8(0x0F);
+			for(; i + 32 <= count; i += 32)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+				__m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+				__m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+				// unpack works per 128-bit lane, the permutes restore byte order
+				__m256i first = _mm256_unpacklo_epi8(hi, lo);
+				__m256i second = _mm256_unpackhi_epi8(hi, lo);
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 2 * i), _mm256_permute2x128_si256(first, second, 0x20));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 2 * i + 32), _mm256_permute2x128_si256(first, second, 0x31));
+			}
+#endif
+#if defined(LIBSUGARX_HAS_SSSE3)
+			const __m128i lut128 = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+			const __m128i mask128 = _mm_set1_epi8(0x0F);
+			for(; i + 16 <= count; i += 16)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+				__m128i hi = _mm_shuffle_epi8(lut128, _mm_and_si128(_mm_srli_epi16(v, 4), mask128));
+				__m128i lo = _mm_shuffle_epi8(lut128, _mm_and_si128(v, mask128));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i), _mm_unpacklo_epi8(hi, lo));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+			}
+#else
+			(void)in;
+			(void)count;
+			(void)out;
+#endif
+			return i;
+		}
+
+#if defined(LIBSUGARX_HAS_AVX2)
+		static __m256i decode_pairs(__m256i v, bool &valid) noexcept
+		{
+			__m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+			__m256i is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+			__m256i is_alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+			valid = valid && _mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha)) == -1;
+			__m256i nibbles = _mm256_or_si256(_mm256_and_si256(is_digit, _mm256_sub_epi8(v, _mm256_set1_epi8('0'))),
+				_mm256_and_si256(is_alpha, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10))));
+			return _mm256_maddubs_epi16(nibbles, _mm256_set1_epi16(0x0110));
+		}
+#endif
+
+#if defined(LIBSUGARX_HAS_SSSE3)
+		// 16 hex chars to 16-bit pairs hi * 16 + lo, invalid lanes are cleared in valid
+		static __m128i decode_pairs(__m128i v, int &valid) noexcept
+		{
+			__m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+			__m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+			__m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+			valid &= _mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha));
+			__m128i nibbles = _mm_or_si128(_mm_and_si128(is_digit, _mm_sub_epi8(v, _mm_set1_epi8('0'))),
+				_mm_and_si128(is_alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+			return _mm_maddubs_epi16(nibbles, _mm_set1_epi16(0x0110));
+		}
+#endif
+
+		// returns how many bytes were decoded, npos on an invalid char
+		static std::size_t decode_simd(const char *in, std::size_t count, std::byte *out) noexcept
+		{
+			std::size_t i = 0;
+#if defined(LIBSUGARX_HAS_AVX2)
+			for(; i + 32 <= count; i += 32)
+			{
+				bool valid = true;
+				__m256i first = decode_pairs(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + 2 * i)), valid);
+				__m256i second = decode_pairs(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + 2 * i + 32)), valid);
+				if(!valid)
+					return npos;
+				// packus works per 128-bit lane, put the 64-bit halves back in order
+				__m256i packed = _mm256_packus_epi16(first, second);
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+			}
+#endif
+#if defined(LIBSUGARX_HAS_SSSE3)
+			for(; i + 16 <= count; i += 16)
+			{
+				int valid = 0xFFFF;
+				__m128i first = decode_pairs(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * i)), valid);
+				__m128i second = decode_pairs(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * i + 16)), valid);
+				if(valid != 0xFFFF)
+					return npos;
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(first, second));
+			}
+#else
+			(void)in;
+			(void)count;
+			(void)out;
+#endif
+			return i;
+		}
+	};
+
+	/*
+	struct string_search
+	find/find_first_of with the same results as std::string_view,
+	scanning 16 (SSE2) or 32 (AVX2) chars per step at runtime.
+	substrings compare the first and last needle char per position and only verify candidates,
+	find_first_of vectorizes sets of up to 8 chars, bigger sets use a 256-bit table.
+	*/
+	struct string_search
+	{
+		static constexpr std::size_t npos = std::string_view::npos;
+
+		[[nodiscard]]
+		static constexpr std::size_t find(std::string_view str, char chr, std::size_t pos = 0U) noexcept
+		{
+			if consteval
+			{
+				return str.find(chr, pos);
+			}
+			else
+			{
+				if(pos >= str.size())
+					return npos;
+				const char *found = find_char(str.data() + pos, str.data() + str.size(), chr);
+				return found ? static_cast<std::size_t>(found - str.data()) : npos;
+			}
+		}
+
+		[[nodiscard]]
+		static constexpr std::size_t find(std::string_view str, std::string_view sub, std::size_t pos = 0U) noexcept
+		{
+			if consteval
+			{
+				return str.find(sub, pos);
+			}
+			else
+			{
+				if(sub.size() <= 1)
+					return sub.empty() ? (pos <= str.size() ? pos : npos) : find(str, sub[0], pos);
+				if(pos > str.size() || str.size() - pos < sub.size())
+					return npos;
+				return find_sub(str, sub, pos);
+			}
+		}
+
+		[[nodiscard]]
+		static constexpr std::size_t find_first_of(std::string_view str, std::string_view set, std::size_t pos = 0U) noexcept
+		{
+			if consteval
+			{
+				return str.find_first_of(set, pos);
+			}
+			else
+			{
+				if(pos >= str.size() || set.empty())
+					return npos;
+				if(set.size() == 1)
+					return find(str, set[0], pos);
+				if(set.size() <= 8)
+					return find_any(str, set, pos);
+
+				std::array<std::uint64_t, 4> bits{};
+				for(char c : set)
+					bits[static_cast<unsigned char>(c) >> 6] |= 1ULL << (static_cast<unsigned char>(c) & 63);
+				for(std::size_t i = pos; i < str.size(); ++i)
+				{
+					unsigned char c = static_cast<unsigned char>(str[i]);
+					if(bits[c >> 6] & (1ULL << (c & 63)))
+						return i;
+				}
+				return npos;
+			}
+		}
+
+	private:
+		static const char *find_char(const char *p, const char *end, char chr) noexcept
+		{
+#if defined(LIBSUGARX_HAS_AVX2)
+			const __m256i wanted = _mm256_set1_epi8(chr);
+			for(; end - p >= 32; p += 32)
+			{
+				int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), wanted));
+				if(mask != 0)
+					return p + std::countr_zero(static_cast<unsigned>(mask));
+			}
+#endif
+#if defined(LIBSUGARX_HAS_SSE2)
+			const __m128i wanted128 = _mm_set1_epi8(chr);
+			for(; end - p >= 16; p += 16)
+			{
+				int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), wanted128));
+				if(mask != 0)
+					return p + std::countr_zero(static_cast<unsigned>(mask));
+			}
+#endif
+			for(; p < end; ++p)
+			{
+				if(*p == chr)
+					return p;
+			}
+			return nullptr;
+		}
+
+		static std::size_t find_sub(std::string_view str, std::string_view sub, std::size_t pos) noexcept
+		{
+			const char *p = str.data();
+			std::size_t last = sub.size() - 1;
+			// a candidate at i needs i + sub.size() <= str.size()
+			std::size_t limit = str.size() - sub.size() + 1;
+			std::size_t i = pos;
+#if defined(LIBSUGARX_HAS_AVX2)
+			const __m256i first = _mm256_set1_epi8(sub.front());
+			const __m256i tail = _mm256_set1_epi8(sub.back());
+			for(; i + 32 <= limit; i += 32)
+			{
+				__m256i head_eq = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i)), first);
+				__m256i tail_eq = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i + last)), tail);
+				unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(head_eq, tail_eq)));
+				for(; mask != 0; mask &= mask - 1)
+				{
+					std::size_t candidate = i + std::countr_zero(mask);
+					if(std::memcmp(p + candidate + 1, sub.data() + 1, last - 1) == 0)
+						return candidate;
+				}
+			}
+#endif
+#if defined(LIBSUGARX_HAS_SSE2)
+			const __m128i first128 = _mm_set1_epi8(sub.front());
+			const __m128i tail128 = _mm_set1_epi8(sub.back());
+			for(; i + 16 <= limit; i += 16)
+			{
+				__m128i head_eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i)), first128);
+				__m128i tail_eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i + last)), tail128);
+				unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(head_eq, tail_eq)));
+				for(; mask != 0; mask &= mask - 1)
+				{
+					std::size_t candidate = i + std::countr_zero(mask);
+					if(std::memcmp(p + candidate + 1, sub.data() + 1, last - 1) == 0)
+						return candidate;
+				}
+			}
+#endif
+			return str.find(sub, i);
+		}
+
+		static std::size_t find_any(std::string_view str, std::string_view set, std::size_t pos) noexcept
+		{
+			const char *p = str.data();
+			std::size_t i = pos;
+#if defined(LIBSUGARX_HAS_AVX2)
+			__m256i wanted[8];
+			for(std::size_t k = 0; k < set.size(); ++k)
+				wanted[k] = _mm256_set1_epi8(set[k]);
+			for(; i + 32 <= str.size(); i += 32)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+				__m256i hit = _mm256_cmpeq_epi8(v, wanted[0]);
+				for(std::size_t k = 1; k < set.size(); ++k)
+					hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, wanted[k]));
+				int mask = _mm256_movemask_epi8(hit);
+				if(mask != 0)
+					return i + std::countr_zero(static_cast<unsigned>(mask));
+			}
+#endif
+#if defined(LIBSUGARX_HAS_SSE2)
+			__m128i wanted128[8];
+			for(std::size_t k = 0; k < set.size(); ++k)
+				wanted128[k] = _mm_set1_epi8(set[k]);
+			for(; i + 16 <= str.size(); i += 16)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+				__m128i hit = _mm_cmpeq_epi8(v, wanted128[0]);
+				for(std::size_t k = 1; k < set.size(); ++k)
+					hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, wanted128[k]));
+				int mask = _mm_movemask_epi8(hit);
+				if(mask != 0)
+					return i + std::countr_zero(static_cast<unsigned>(mask));
+			}
+#endif
+			return str.find_first_of(set, i);
+		}
+	};
+
+	/*
+	class string_split
+	range of the string_view fields of str between any of the delimiters,
+	like Python's str.split(sep): "a,,b" gives "a", "", "b" and "" gives one empty field.
+	fields point into str, nothing is allocated.
+	*/
+	class string_split : public std::ranges::view_interface<string_split>
+	{
+		std::string_view str_;
+		std::string_view delimiters_;
+
+	public:
+		class iterator
+		{
+			std::string_view str_;
+			std::string_view delimiters_;
+			std::size_t begin_ = 0;
+			std::size_t end_ = 0;
+			bool done_ = true;
+
+			constexpr std::size_t next_delimiter(std::size_t pos) const noexcept
+			{
+				if(delimiters_.size() == 1)
+					return string_search::find(str_, delimiters_[0], pos);
+				return string_search::find_first_of(str_, delimiters_, pos);
+			}
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::string_view;
+			using difference_type = std::ptrdiff_t;
+
+			constexpr iterator() = default;
+			constexpr iterator(std::string_view str, std::string_view delimiters) noexcept
+				: str_(str), delimiters_(delimiters), end_(next_delimiter(0)), done_(false)
+			{
+			}
+
+			constexpr std::string_view operator*() const noexcept
+			{
+				return str_.substr(begin_, end_ == std::string_view::npos ? std::string_view::npos : end_ - begin_);
+			}
+
+			constexpr iterator &operator++() noexcept
+			{
+				if(end_ == std::string_view::npos)
+					done_ = true;
+				else
+				{
+					begin_ = end_ + 1;
+					end_ = next_delimiter(begin_);
+				}
+				return *this;
+			}
+
+			constexpr iterator operator++(int) noexcept
+			{
+				iterator result = *this;
+				++*this;
+				return result;
+			}
+
+			constexpr bool operator==(const iterator &other) const noexcept
+			{
+				return done_ == other.done_ && (done_ || begin_ == other.begin_);
+			}
+
+			constexpr bool operator==(std::default_sentinel_t) const noexcept { return done_; }
+		};
+
+		constexpr string_split() = default;
+		constexpr string_split(std::string_view str, std::string_view delimiters) noexcept : str_(str), delimiters_(delimiters) {}
+
+		constexpr iterator begin() const noexcept { return iterator(str_, delimiters_); }
+		constexpr std::default_sentinel_t end() const noexcept { return std::default_sentinel; }
+	};
+
 	template<std::size_t N>
 	static constexpr void string_append_byte(fixed_string<N> &str, std::byte byte)
 	{
-		static const char hex_digits[] = "0123456789abcdef";
-		unsigned char c = static_cast<unsigned char>(byte);
-		str.concat(hex_digits[c >> 4]);
-		str.concat(hex_digits[c & 0x0F]);
+		std::array<char, 2> hex{};
+		hex_codec::encode(const_data_span(&byte, 1), hex);
+		str.concat(std::string_view(hex.data(), hex.size()));
 	};
 
 	template<std::size_t N>
@@ -98,8 +1145,8 @@ namespace libsugarx
 	static constexpr fixed_string<N> bytes_to_hex_string(const_data_span bytes)
 	{
 		fixed_string<N> result;
-		for(std::size_t i = 0; i < bytes.size() && i < N / 2; i++)
-			string_append_byte(result, bytes[i]);
+		std::size_t written = hex_codec::encode(bytes, std::span<char>(result.data(), N - 1));
+		result.resize(written);
 		return result;
 	};
 
@@ -107,17 +1154,33 @@ namespace libsugarx
 	class fixed_string
 	wrapper of std::array<char, N>
 	to make it more easy to use.
+	the length is cached, for N <= 256 it lives in the last byte as the remaining capacity,
+	which becomes the terminator once the string is full, so sizeof stays N.
+	text that doesn't fit is cut on a UTF-8 code point boundary.
 	*/
 	template<std::size_t N>
 	class fixed_string
 	{
+		static constexpr bool inline_length = N <= 256;
+		struct no_length {};
+
 		std::array<char, N> buffer{};
+		[[no_unique_address]] std::conditional_t<inline_length, no_length, std::size_t> length_{};
+
+		constexpr void set_length(std::size_t len) noexcept
+		{
+			buffer[len] = '\0';
+			if constexpr(inline_length)
+				buffer[N - 1] = static_cast<char>(N - 1 - len);
+			else
+				length_ = len;
+		}
 
 	public:
 		constexpr fixed_string() noexcept
 		{
 			static_assert(N > 1, "String buffer must own enough memory size.");
-			buffer[0] = '\0';
+			set_length(0);
 		}
 
 		constexpr fixed_string(std::string_view other) noexcept
@@ -128,70 +1191,124 @@ namespace libsugarx
 
 		constexpr bool copy(std::string_view other) noexcept
 		{
-			std::size_t len = std::min(other.size(), N - 1);
+			std::size_t len = utf8::truncate_length(other, N - 1);
 			std::copy(other.data(), other.data() + len, buffer.data());
-			buffer[len] = '\0';
+			set_length(len);
 			return true;
 		}
 
 		constexpr void concat(const char &chr) noexcept
 		{
 			std::size_t current_len = length();
-			std::ptrdiff_t available = N - current_len - 1;
-
-			if(available > 0)
+			if(current_len < N - 1)
 			{
 				buffer[current_len] = chr;
-				buffer[current_len + 1] = '\0';
+				set_length(current_len + 1);
 			}
 		}
 
 		constexpr void concat(std::string_view other)
 		{
 			std::size_t current_len = length();
-			std::size_t append_len = other.length();
-			std::ptrdiff_t available = N - current_len - 1;
-
-			if(available > 0 && append_len > 0)
+			std::size_t copy_len = utf8::truncate_length(other, N - 1 - current_len);
+			if(copy_len > 0)
 			{
-				std::size_t copy_len = (append_len < available) ? append_len : available;
 				std::copy(other.data(), other.data() + copy_len, data() + current_len);
-				buffer[current_len + copy_len] = '\0';
+				set_length(current_len + copy_len);
 			}
 		}
 
 		template<typename... Args>
 		/*
-		return true on success
+		fmt is checked at compile time, the output is written straight into the buffer,
+		no allocation and no exception unless a formatter throws.
+		*/
+		constexpr format_result format(std::format_string<Args...> fmt, Args &&...args)
+		{
+			clear();
+			return append_format(fmt, std::forward<Args>(args)...);
+		}
+
+		template<typename... Args>
+		/*
+		same as format, but writes after the current contents.
+		*/
+		constexpr format_result append_format(std::format_string<Args...> fmt, Args &&...args)
+		{
+			std::size_t current_len = length();
+			std::size_t available = N - 1 - current_len;
+			auto result = std::format_to_n(data() + current_len, static_cast<std::ptrdiff_t>(available), fmt, std::forward<Args>(args)...);
+			std::size_t size = static_cast<std::size_t>(result.size);
+			std::string_view written(data() + current_len, static_cast<std::size_t>(result.out - (data() + current_len)));
+			set_length(current_len + (size > available ? utf8::complete_prefix(written) : written.size()));
+			return format_result{current_len + size, size > available};
+		}
+
+		template<typename Fmt, typename... Args>
+		requires runtime_format_string<Fmt>
+		/*
+		for format strings only known at runtime, reports truncation like the checked overload.
+		a bad format string clears the string and reports {0, true}.
 		*/
-		constexpr bool format(std::string_view fmt, Args &&...args)
+		constexpr format_result format(const Fmt &runtime_fmt, Args &&...args)
 		{
+			std::string_view fmt = runtime_fmt;
 			if constexpr(sizeof...(Args) == 0)
 			{
-				return copy(fmt);
+				copy(fmt);
+				return format_result{fmt.size(), fmt.size() > N - 1};
 			}
 
 			try
 			{
 				bounded_buffer_iterator<N> iter(data());
 				auto end = std::vformat_to(iter, fmt, std::make_format_args(args...));
-				*(end.end_ptr()) = '\0';
+				std::string_view written(data(), static_cast<std::size_t>(end.end_ptr() - data()));
+				set_length(end.truncated() ? utf8::complete_prefix(written) : written.size());
+				return format_result{end.size(), end.truncated()};
 			}
 			catch(const std::format_error &e)
 			{
-				return false;
+				clear();
+				return format_result{0, true};
 			}
-			return true;
 		}
 
-		constexpr std::size_t find(std::string_view sub, std::size_t pos = 0U) const noexcept { return view().find(sub, pos); }
+		/*
+		sets the length after writing through data(), clamped to N - 1.
+		*/
+		constexpr void resize(std::size_t len) noexcept
+		{
+			set_length(std::min(len, N - 1));
+		}
+
+		/*
+		recomputes the cached length,
+		call it after writing through data(), buffer_data() or operator[].
+		*/
+		constexpr void sync_length() noexcept
+		{
+			auto end = std::find(buffer.begin(), buffer.begin() + (N - 1), '\0');
+			set_length(static_cast<std::size_t>(end - buffer.begin()));
+		}
+
+		constexpr std::size_t find(std::string_view sub, std::size_t pos = 0U) const noexcept { return string_search::find(view(), sub, pos); }
+		constexpr std::size_t find(char chr, std::size_t pos = 0U) const noexcept { return string_search::find(view(), chr, pos); }
+		constexpr std::size_t find_first_of(std::string_view set, std::size_t pos = 0U) const noexcept { return string_search::find_first_of(view(), set, pos); }
 		constexpr bool starts_with(std::string_view sub) const noexcept { return view().starts_with(sub); }
+		constexpr string_split split(std::string_view delimiters) const noexcept { return string_split(view(), delimiters); }
 
 		constexpr std::size_t max_size() const { return N; }
-		constexpr std::size_t length() const { return std::char_traits<char>::length(data()); }
+		constexpr std::size_t length() const noexcept
+		{
+			if constexpr(inline_length)
+				return N - 1 - static_cast<unsigned char>(buffer[N - 1]);
+			else
+				return length_;
+		}
 
 		constexpr std::array<char, N> &buffer_data() { return buffer; }
-		constexpr std::array<char, N> &buffer_data() const { return buffer; }
+		constexpr const std::array<char, N> &buffer_data() const { return buffer; }
 
 		constexpr char *data() { return buffer.data(); }
 		constexpr const char *data() const { return buffer.data(); }
@@ -200,11 +1317,11 @@ namespace libsugarx
 		constexpr const char &operator[](std::size_t index) const { return buffer[index]; }
 
 		constexpr char &at(std::size_t index) { return buffer.at(index); }
-		constexpr char &at(std::size_t index) const { return buffer.at(index); }
+		constexpr const char &at(std::size_t index) const { return buffer.at(index); }
 		// is empty
-		constexpr bool empty() { return length() == 0; }
+		constexpr bool empty() const { return length() == 0; }
 
-		constexpr void clear() { buffer[0] = '\0'; }
+		constexpr void clear() { set_length(0); }
 
 		constexpr std::string_view view() const { return std::string_view(data(), length()); }
 
@@ -230,6 +1347,271 @@ namespace libsugarx
 		return a.view() == b;
 	}
 
+	/*
+	class small_string
+	growable string keeping up to N - 1 chars inline in a fixed_string<N>,
+	longer contents spill to a buffer from Allocator (heap, or an arena through pmr).
+	once spilled it stays on that buffer, clear() keeps the capacity like std::string.
+	*/
+	template<std::size_t N, typename Allocator = std::allocator<char>>
+	class small_string
+	{
+		using char_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<char>;
+		using traits = std::allocator_traits<char_allocator>;
+
+		fixed_string<N> inline_;
+		char *heap_ = nullptr;
+		std::size_t heap_length_ = 0;
+		std::size_t heap_capacity_ = 0;
+		[[no_unique_address]] char_allocator allocator_;
+
+		/*
+		moves to a new buffer holding head followed by tail, capacity excludes the terminator.
+		the old buffer is released last, so head and tail may point into it.
+		*/
+		void grow(std::size_t capacity, std::string_view head, std::string_view tail = {})
+		{
+			capacity = std::max(capacity, 2 * this->capacity());
+			char *buffer = traits::allocate(allocator_, capacity + 1);
+			std::copy(head.begin(), head.end(), buffer);
+			std::copy(tail.begin(), tail.end(), buffer + head.size());
+			buffer[head.size() + tail.size()] = '\0';
+			release();
+			heap_ = buffer;
+			heap_length_ = head.size() + tail.size();
+			heap_capacity_ = capacity;
+		}
+
+		void release() noexcept
+		{
+			if(heap_)
+				traits::deallocate(allocator_, heap_, heap_capacity_ + 1);
+			heap_ = nullptr;
+			heap_length_ = 0;
+			heap_capacity_ = 0;
+		}
+
+		void set_heap_length(std::size_t len) noexcept
+		{
+			heap_length_ = len;
+			heap_[len] = '\0';
+		}
+
+		void steal(small_string &other) noexcept
+		{
+			inline_ = other.inline_;
+			heap_ = std::exchange(other.heap_, nullptr);
+			heap_length_ = std::exchange(other.heap_length_, 0);
+			heap_capacity_ = std::exchange(other.heap_capacity_, 0);
+			other.inline_.clear();
+		}
+
+	public:
+		using allocator_type = Allocator;
+
+		small_string() noexcept(std::is_nothrow_default_constructible_v<char_allocator>) = default;
+
+		explicit small_string(const Allocator &allocator) noexcept : allocator_(allocator) {}
+
+		small_string(std::string_view other, const Allocator &allocator = Allocator()) : allocator_(allocator)
+		{
+			copy(other);
+		}
+
+		small_string(const small_string &other) : allocator_(traits::select_on_container_copy_construction(other.allocator_))
+		{
+			copy(other.view());
+		}
+
+		small_string(small_string &&other) noexcept : allocator_(std::move(other.allocator_))
+		{
+			steal(other);
+		}
+
+		small_string &operator=(const small_string &other)
+		{
+			if(this != &other)
+				copy(other.view());
+			return *this;
+		}
+
+		small_string &operator=(small_string &&other) noexcept(traits::propagate_on_container_move_assignment::value || traits::is_always_equal::value)
+		{
+			if(this == &other)
+				return *this;
+			if constexpr(traits::propagate_on_container_move_assignment::value)
+			{
+				release();
+				allocator_ = std::move(other.allocator_);
+				steal(other);
+			}
+			else
+			{
+				if(allocator_ == other.allocator_)
+				{
+					release();
+					steal(other);
+				}
+				else
+					copy(other.view());
+			}
+			return *this;
+		}
+
+		small_string &operator=(std::string_view other)
+		{
+			copy(other);
+			return *this;
+		}
+
+		~small_string()
+		{
+			release();
+		}
+
+		allocator_type get_allocator() const noexcept { return allocator_type(allocator_); }
+
+		bool is_inline() const noexcept { return heap_ == nullptr; }
+
+		void reserve(std::size_t capacity)
+		{
+			if(capacity > this->capacity())
+				grow(capacity, view());
+		}
+
+		/*
+		copy, concat and operator= may take a view of this string's own contents.
+		*/
+		bool copy(std::string_view other)
+		{
+			if(is_inline() && other.size() < N)
+				return inline_.copy(other);
+			if(other.size() > capacity())
+				grow(other.size(), other);
+			else
+			{
+				// other may overlap the buffer
+				std::char_traits<char>::move(heap_, other.data(), other.size());
+				set_heap_length(other.size());
+			}
+			return true;
+		}
+
+		void concat(const char &chr)
+		{
+			if(is_inline() && inline_.length() + 1 < N)
+			{
+				inline_.concat(chr);
+				return;
+			}
+			// chr may live in the buffer grow is about to release
+			concat(std::string_view(&chr, 1));
+		}
+
+		void concat(std::string_view other)
+		{
+			if(is_inline() && inline_.length() + other.size() < N)
+			{
+				inline_.concat(other);
+				return;
+			}
+			std::size_t current_len = length();
+			if(current_len + other.size() > capacity())
+				grow(current_len + other.size(), view(), other);
+			else
+			{
+				std::copy(other.begin(), other.end(), heap_ + current_len);
+				set_heap_length(current_len + other.size());
+			}
+		}
+
+		template<typename... Args>
+		/*
+		never truncates, grows once if the output doesn't fit.
+		*/
+		void format(std::format_string<Args...> fmt, Args &&...args)
+		{
+			clear();
+			append_format(fmt, std::forward<Args>(args)...);
+		}
+
+		template<typename... Args>
+		/*
+		output that doesn't fit the free space is formatted a second time after one grow,
+		args are passed as lvalues so neither pass moves from them,
+		but a formatter with side effects runs twice then.
+		*/
+		void append_format(std::format_string<Args...> fmt, Args &&...args)
+		{
+			// fmt was checked at compile time, both passes share it with type-erased args
+			auto erased_args = std::make_format_args(args...);
+			std::size_t current_len = length();
+			bounded_buffer_iterator<N> end = std::vformat_to(bounded_buffer_iterator<N>(data() + current_len, capacity() - current_len), fmt.get(), erased_args);
+			std::size_t len = current_len + end.size();
+			if(!end.truncated())
+			{
+				if(is_inline())
+					inline_.resize(len);
+				else
+					set_heap_length(len);
+				return;
+			}
+
+			// drop the cut output, it's written again after growing
+			if(is_inline())
+				inline_.resize(current_len);
+			reserve(len);
+			std::vformat_to(heap_ + current_len, fmt.get(), erased_args);
+			set_heap_length(len);
+		}
+
+		std::size_t find(std::string_view sub, std::size_t pos = 0U) const noexcept { return string_search::find(view(), sub, pos); }
+		std::size_t find(char chr, std::size_t pos = 0U) const noexcept { return string_search::find(view(), chr, pos); }
+		std::size_t find_first_of(std::string_view set, std::size_t pos = 0U) const noexcept { return string_search::find_first_of(view(), set, pos); }
+		bool starts_with(std::string_view sub) const noexcept { return view().starts_with(sub); }
+		string_split split(std::string_view delimiters) const noexcept { return string_split(view(), delimiters); }
+
+		std::size_t length() const noexcept { return is_inline() ? inline_.length() : heap_length_; }
+		std::size_t capacity() const noexcept { return is_inline() ? N - 1 : heap_capacity_; }
+		bool empty() const noexcept { return length() == 0; }
+
+		char *data() noexcept { return is_inline() ? inline_.data() : heap_; }
+		const char *data() const noexcept { return is_inline() ? inline_.data() : heap_; }
+
+		char &operator[](std::size_t index) noexcept { return data()[index]; }
+		const char &operator[](std::size_t index) const noexcept { return data()[index]; }
+
+		void clear() noexcept
+		{
+			if(is_inline())
+				inline_.clear();
+			else
+				set_heap_length(0);
+		}
+
+		std::string_view view() const noexcept { return std::string_view(data(), length()); }
+
+		operator std::string_view() const noexcept { return view(); }
+	};
+
+	template<std::size_t N, typename A, std::size_t N1, typename A1>
+	bool operator==(const small_string<N, A> &a, const small_string<N1, A1> &b)
+	{
+		return a.view() == b.view();
+	}
+
+	template<std::size_t N, typename A>
+	bool operator==(const small_string<N, A> &a, std::string_view b)
+	{
+		return a.view() == b;
+	}
+
+	namespace pmr
+	{
+		template<std::size_t N>
+		using small_string = libsugarx::small_string<N, std::pmr::polymorphic_allocator<char>>;
+	} // namespace pmr
+
 }; // namespace libsugarx
 
 namespace std
@@ -249,13 +1631,33 @@ namespace std
 		}
 	};
 
+	template<std::size_t N, typename Allocator>
+	struct formatter<libsugarx::small_string<N, Allocator>, char> : formatter<string_view, char>
+	{
+		template<typename FormatContext>
+		auto format(const libsugarx::small_string<N, Allocator> &str, FormatContext &ctx) const -> decltype(ctx.out())
+		{
+			return formatter<string_view, char>::format(str.view(), ctx);
+		}
+	};
+
 	template<std::size_t N>
 	struct hash<libsugarx::fixed_string<N>>
 	{
 		[[nodiscard]]
 		size_t operator()(const libsugarx::fixed_string<N> &buf) const noexcept
 		{
-			return std::hash<std::string_view>{}(buf.view());
+			return libsugarx::wide_string_hash{}(buf.view());
+		}
+	};
+
+	template<std::size_t N, typename Allocator>
+	struct hash<libsugarx::small_string<N, Allocator>>
+	{
+		[[nodiscard]]
+		size_t operator()(const libsugarx::small_string<N, Allocator> &str) const noexcept
+		{
+			return libsugarx::wide_string_hash{}(str.view());
 		}
 	};
 
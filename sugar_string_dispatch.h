@@ -0,0 +1,165 @@
+#ifndef LIBSUGARX_STRING_DISPATCH_H
+#define LIBSUGARX_STRING_DISPATCH_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "sugar_string.h"
+
+namespace libsugarx
+{
+	/*
+	class string_dispatch
+	perfect hash from a fixed set of names to their index, built at compile time.
+	a lookup is one wide_string_hash, one pilot load, one slot load and one compare.
+
+	constexpr auto commands = make_string_dispatch({"get", "set", "del"});
+	switch(commands.find(word)) { case 0: ...; case string_dispatch<3>::npos: ... }
+
+	names are bucketed by hash, every bucket gets a pilot that moves its names
+	to free slots (PTHash style), with slots at most 80% full the search is short.
+	duplicate names fail the build.
+	*/
+	template<std::size_t N>
+	class string_dispatch
+	{
+		static_assert(N > 0, "string_dispatch needs at least one name.");
+
+	public:
+		static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+		static constexpr std::size_t table_size = std::bit_ceil(N + N / 4 + 2);
+		static constexpr std::size_t bucket_count = std::max<std::size_t>(N / 2, 1);
+
+		using index_type = std::conditional_t<(N < 0xFF), std::uint8_t, std::conditional_t<(N < 0xFFFF), std::uint16_t, std::uint32_t>>;
+
+		consteval explicit string_dispatch(const std::array<std::string_view, N> &names) : names_(names)
+		{
+			build();
+		}
+
+		/*
+		returns the index of name, npos if it isn't one of the names.
+		*/
+		[[nodiscard]]
+		constexpr std::size_t find(std::string_view name) const noexcept
+		{
+			std::uint64_t hash = wide_string_hash::hash(name);
+			index_type index = slots_[slot_of(hash, pilots_[bucket_of(hash)])];
+			if(index == empty_slot || names_[index] != name)
+				return npos;
+			return index;
+		}
+
+		template<typename E>
+		requires std::is_enum_v<E>
+		/*
+		the enum's values must follow the order of the names.
+		*/
+		[[nodiscard]]
+		constexpr std::optional<E> find_as(std::string_view name) const noexcept
+		{
+			std::size_t index = find(name);
+			if(index == npos)
+				return std::nullopt;
+			return static_cast<E>(index);
+		}
+
+		[[nodiscard]]
+		constexpr bool contains(std::string_view name) const noexcept { return find(name) != npos; }
+
+		constexpr std::string_view operator[](std::size_t index) const noexcept { return names_[index]; }
+		static constexpr std::size_t size() noexcept { return N; }
+
+	private:
+		static constexpr index_type empty_slot = static_cast<index_type>(-1);
+		static constexpr int slot_shift = 64 - std::countr_zero(table_size);
+
+		static constexpr std::size_t bucket_of(std::uint64_t hash) noexcept
+		{
+			return static_cast<std::size_t>(((hash >> 32) * bucket_count) >> 32);
+		}
+
+		static constexpr std::size_t slot_of(std::uint64_t hash, std::uint16_t pilot) noexcept
+		{
+			return static_cast<std::size_t>(((hash ^ (pilot * 0x9E3779B97F4A7C15ULL)) * 0xC2B2AE3D27D4EB4FULL) >> slot_shift);
+		}
+
+		consteval void build()
+		{
+			std::array<std::uint64_t, N> hashes{};
+			for(std::size_t i = 0; i < N; ++i)
+			{
+				hashes[i] = wide_string_hash::hash(names_[i]);
+				for(std::size_t j = 0; j < i; ++j)
+				{
+					if(names_[i] == names_[j])
+						throw std::invalid_argument("string_dispatch: duplicate name");
+				}
+			}
+
+			// names grouped by bucket, biggest buckets placed first
+			std::array<std::size_t, N> order{};
+			std::array<std::size_t, bucket_count> sizes{};
+			for(std::size_t i = 0; i < N; ++i)
+			{
+				order[i] = i;
+				++sizes[bucket_of(hashes[i])];
+			}
+			std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+				std::size_t bucket_a = bucket_of(hashes[a]);
+				std::size_t bucket_b = bucket_of(hashes[b]);
+				if(sizes[bucket_a] != sizes[bucket_b])
+					return sizes[bucket_a] > sizes[bucket_b];
+				return bucket_a < bucket_b;
+			});
+
+			slots_.fill(empty_slot);
+			for(std::size_t begin = 0; begin < N;)
+			{
+				std::size_t bucket = bucket_of(hashes[order[begin]]);
+				std::size_t end = begin + sizes[bucket];
+				pilots_[bucket] = find_pilot(hashes, order, begin, end);
+				for(std::size_t i = begin; i < end; ++i)
+					slots_[slot_of(hashes[order[i]], pilots_[bucket])] = static_cast<index_type>(order[i]);
+				begin = end;
+			}
+		}
+
+		consteval std::uint16_t find_pilot(const std::array<std::uint64_t, N> &hashes, const std::array<std::size_t, N> &order, std::size_t begin, std::size_t end) const
+		{
+			for(std::uint32_t pilot = 0; pilot <= 0xFFFF; ++pilot)
+			{
+				bool placed = true;
+				for(std::size_t i = begin; i < end && placed; ++i)
+				{
+					std::size_t slot = slot_of(hashes[order[i]], static_cast<std::uint16_t>(pilot));
+					placed = slots_[slot] == empty_slot;
+					// names of the same bucket must not collide with each other either
+					for(std::size_t j = begin; j < i && placed; ++j)
+						placed = slot_of(hashes[order[j]], static_cast<std::uint16_t>(pilot)) != slot;
+				}
+				if(placed)
+					return static_cast<std::uint16_t>(pilot);
+			}
+			throw std::invalid_argument("string_dispatch: no pilot found, names may share a hash");
+		}
+
+		std::array<std::string_view, N> names_{};
+		std::array<std::uint16_t, bucket_count> pilots_{};
+		std::array<index_type, table_size> slots_{};
+	};
+
+	template<std::size_t N>
+	consteval string_dispatch<N> make_string_dispatch(const std::string_view (&names)[N])
+	{
+		return string_dispatch<N>(std::to_array(names));
+	}
+} // namespace libsugarx
+
+#endif // LIBSUGARX_STRING_DISPATCH_H
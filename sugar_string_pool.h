@@ -0,0 +1,335 @@
+#ifndef LIBSUGARX_STRING_POOL_H
+#define LIBSUGARX_STRING_POOL_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "sugar_string.h"
+
+namespace libsugarx
+{
+	/*
+	struct string_symbol
+	id of a string interned in a string_pool,
+	comparing and hashing symbols never touches the characters.
+	*/
+	struct string_symbol
+	{
+		static constexpr std::uint32_t invalid = 0xFFFFFFFFU;
+		std::uint32_t id = invalid;
+
+		constexpr bool valid() const noexcept { return id != invalid; }
+		auto operator<=>(const string_symbol &other) const = default;
+	};
+
+	/*
+	class string_pool
+	interns strings, one copy per distinct string, each mapped to a stable 32-bit string_symbol.
+	strings are spread over Shards by hash, each shard has its own arena and open-addressing table.
+	find/view are lock-free: tables are published with release stores and never freed before the pool,
+	intern takes only the owning shard's mutex when the string is new.
+	interned strings are null-terminated and stay at the same address until the pool dies.
+	*/
+	template<std::size_t Shards = 16>
+	class basic_string_pool
+	{
+		static_assert(std::has_single_bit(Shards), "Shards must be a power of two.");
+
+	public:
+		basic_string_pool() = default;
+
+		basic_string_pool(const basic_string_pool &other) = delete;
+		basic_string_pool &operator=(const basic_string_pool &other) = delete;
+
+		~basic_string_pool()
+		{
+			for(shard &target : shards_)
+			{
+				for(std::size_t i = 0; i < target.segments.size(); ++i)
+					delete[] target.segments[i].load(std::memory_order_relaxed);
+			}
+		}
+
+		/*
+		returns the symbol of str, adding it if it's new.
+		throws std::length_error once a shard runs out of ids.
+		*/
+		string_symbol intern(std::string_view str)
+		{
+			std::uint64_t hash = wide_string_hash::hash(str);
+			std::size_t index = shard_index(hash);
+			shard &target = shards_[index];
+			if(std::optional<string_symbol> found = find_in(target, index, str, hash))
+				return *found;
+
+			std::lock_guard lock(target.mutex);
+			// another thread may have added it while we waited
+			if(std::optional<string_symbol> found = find_in(target, index, str, hash))
+				return *found;
+
+			std::uint32_t local = target.count.load(std::memory_order_relaxed);
+			if(local >= max_local_ids)
+				throw std::length_error("string_pool shard is full");
+
+			symbol_entry &entry = entry_slot(target, local);
+			entry.data = store(target, str);
+			entry.length = static_cast<std::uint32_t>(str.size());
+
+			table *current = target.current.load(std::memory_order_relaxed);
+			if(!current || (local + 1) * 2 > current->capacity)
+				current = grow(target, current);
+			insert_into(*current, hash, local);
+			target.count.store(local + 1, std::memory_order_release);
+			return string_symbol{make_id(local, index)};
+		}
+
+		/*
+		lock-free, std::nullopt if str was never interned.
+		*/
+		std::optional<string_symbol> find(std::string_view str) const noexcept
+		{
+			std::uint64_t hash = wide_string_hash::hash(str);
+			std::size_t index = shard_index(hash);
+			return find_in(shards_[index], index, str, hash);
+		}
+
+		bool contains(std::string_view str) const noexcept { return find(str).has_value(); }
+
+		/*
+		lock-free, symbol must come from this pool.
+		*/
+		std::string_view view(string_symbol symbol) const noexcept
+		{
+			const symbol_entry &entry = entry_at(shards_[symbol.id & (Shards - 1)], symbol.id >> shard_bits);
+			return std::string_view(entry.data, entry.length);
+		}
+
+		const char *c_str(string_symbol symbol) const noexcept { return view(symbol).data(); }
+
+		std::size_t size() const noexcept
+		{
+			std::size_t result = 0;
+			for(const shard &target : shards_)
+				result += target.count.load(std::memory_order_acquire);
+			return result;
+		}
+
+		bool empty() const noexcept { return size() == 0; }
+
+		// arena and table bytes held by the pool
+		std::size_t allocated_bytes() const
+		{
+			std::size_t result = 0;
+			for(const shard &target : shards_)
+			{
+				std::lock_guard lock(target.mutex);
+				result += target.chunks.size() * chunk_size + target.large_bytes;
+				for(const std::unique_ptr<table> &retired : target.tables)
+					result += retired->capacity * sizeof(std::atomic<std::uint64_t>);
+				for(std::size_t i = 0; i < target.segments.size(); ++i)
+				{
+					if(target.segments[i].load(std::memory_order_relaxed))
+						result += (segment_base << i) * sizeof(symbol_entry);
+				}
+			}
+			return result;
+		}
+
+	private:
+		static constexpr int shard_bits = std::countr_zero(Shards);
+		static constexpr std::uint32_t max_local_ids = (0xFFFFFFFFU >> shard_bits) - 1;
+		static constexpr std::size_t chunk_size = 64 * 1024;
+		static constexpr std::size_t segment_base = 64;
+		static constexpr int segment_base_bits = std::countr_zero(segment_base);
+
+		struct symbol_entry
+		{
+			const char *data = nullptr;
+			std::uint32_t length = 0;
+		};
+
+		/*
+		slot = high 32 bits of the hash << 32 | (local id + 1), 0 is empty.
+		*/
+		struct table
+		{
+			std::size_t capacity;
+			std::unique_ptr<std::atomic<std::uint64_t>[]> slots;
+
+			explicit table(std::size_t size) : capacity(size), slots(new std::atomic<std::uint64_t>[size])
+			{
+				for(std::size_t i = 0; i < size; ++i)
+					slots[i].store(0, std::memory_order_relaxed);
+			}
+		};
+
+		// keep shards on separate cache lines so their locks don't false share
+		struct alignas(64) shard
+		{
+			mutable std::mutex mutex;
+			std::atomic<table *> current{nullptr};
+			std::atomic<std::uint32_t> count{0};
+			// id -> string, segment i holds segment_base << i entries and never moves
+			std::array<std::atomic<symbol_entry *>, 32> segments{};
+
+			// only touched under mutex
+			std::vector<std::unique_ptr<table>> tables;
+			std::vector<std::unique_ptr<char[]>> chunks;
+			std::vector<std::unique_ptr<char[]>> large;
+			std::size_t chunk_used = chunk_size;
+			std::size_t large_bytes = 0;
+		};
+
+		static std::size_t shard_index(std::uint64_t hash) noexcept
+		{
+			if constexpr(Shards == 1)
+				return 0;
+			else
+				return static_cast<std::size_t>(hash >> (64 - shard_bits));
+		}
+
+		static std::uint32_t make_id(std::uint32_t local, std::size_t shard) noexcept
+		{
+			return (local << shard_bits) | static_cast<std::uint32_t>(shard);
+		}
+
+		static std::pair<std::size_t, std::size_t> segment_of(std::uint32_t local) noexcept
+		{
+			std::size_t biased = static_cast<std::size_t>(local) + segment_base;
+			std::size_t segment = static_cast<std::size_t>(std::bit_width(biased)) - 1 - segment_base_bits;
+			return {segment, biased - (segment_base << segment)};
+		}
+
+		static const symbol_entry &entry_at(const shard &target, std::uint32_t local) noexcept
+		{
+			auto [segment, offset] = segment_of(local);
+			return target.segments[segment].load(std::memory_order_acquire)[offset];
+		}
+
+		// under the shard mutex
+		static symbol_entry &entry_slot(shard &target, std::uint32_t local)
+		{
+			auto [segment, offset] = segment_of(local);
+			symbol_entry *entries = target.segments[segment].load(std::memory_order_relaxed);
+			if(!entries)
+			{
+				entries = new symbol_entry[segment_base << segment];
+				target.segments[segment].store(entries, std::memory_order_release);
+			}
+			return entries[offset];
+		}
+
+		// under the shard mutex
+		static const char *store(shard &target, std::string_view str)
+		{
+			std::size_t bytes = str.size() + 1;
+			char *out;
+			if(bytes > chunk_size / 4)
+			{
+				// big strings get their own block, so chunks stay dense
+				target.large.emplace_back(new char[bytes]);
+				target.large_bytes += bytes;
+				out = target.large.back().get();
+			}
+			else
+			{
+				if(target.chunk_used + bytes > chunk_size)
+				{
+					target.chunks.emplace_back(new char[chunk_size]);
+					target.chunk_used = 0;
+				}
+				out = target.chunks.back().get() + target.chunk_used;
+				target.chunk_used += bytes;
+			}
+			std::memcpy(out, str.data(), str.size());
+			out[str.size()] = '\0';
+			return out;
+		}
+
+		static void insert_into(table &into, std::uint64_t hash, std::uint32_t local) noexcept
+		{
+			std::uint64_t slot_value = (hash & 0xFFFFFFFF00000000ULL) | (static_cast<std::uint64_t>(local) + 1);
+			std::size_t mask = into.capacity - 1;
+			for(std::size_t pos = static_cast<std::size_t>(hash) & mask;; pos = (pos + 1) & mask)
+			{
+				if(into.slots[pos].load(std::memory_order_relaxed) == 0)
+				{
+					into.slots[pos].store(slot_value, std::memory_order_release);
+					return;
+				}
+			}
+		}
+
+		// under the shard mutex, readers keep using the old table until the new one is published
+		table *grow(shard &target, table *current)
+		{
+			std::size_t capacity = current ? current->capacity * 2 : 64;
+			std::unique_ptr<table> next = std::make_unique<table>(capacity);
+			if(current)
+			{
+				std::uint32_t count = target.count.load(std::memory_order_relaxed);
+				for(std::uint32_t local = 0; local < count; ++local)
+				{
+					const symbol_entry &entry = entry_at(target, local);
+					insert_into(*next, wide_string_hash::hash(std::string_view(entry.data, entry.length)), local);
+				}
+			}
+			table *result = next.get();
+			target.tables.push_back(std::move(next));
+			target.current.store(result, std::memory_order_release);
+			return result;
+		}
+
+		static std::optional<string_symbol> find_in(const shard &target, std::size_t index, std::string_view str, std::uint64_t hash) noexcept
+		{
+			const table *current = target.current.load(std::memory_order_acquire);
+			if(!current)
+				return std::nullopt;
+
+			std::uint64_t tag = hash & 0xFFFFFFFF00000000ULL;
+			std::size_t mask = current->capacity - 1;
+			for(std::size_t pos = static_cast<std::size_t>(hash) & mask;; pos = (pos + 1) & mask)
+			{
+				std::uint64_t slot_value = current->slots[pos].load(std::memory_order_acquire);
+				if(slot_value == 0)
+					return std::nullopt;
+				if((slot_value & 0xFFFFFFFF00000000ULL) != tag)
+					continue;
+
+				std::uint32_t local = static_cast<std::uint32_t>(slot_value) - 1;
+				const symbol_entry &entry = entry_at(target, local);
+				if(std::string_view(entry.data, entry.length) == str)
+					return string_symbol{make_id(local, index)};
+			}
+		}
+
+		std::array<shard, Shards> shards_;
+	};
+
+	using string_pool = basic_string_pool<>;
+} // namespace libsugarx
+
+namespace std
+{
+	template<>
+	struct hash<libsugarx::string_symbol>
+	{
+		size_t operator()(const libsugarx::string_symbol &symbol) const noexcept
+		{
+			std::uint64_t h = symbol.id * 0x9E3779B97F4A7C15ULL;
+			return static_cast<size_t>(h ^ (h >> 32));
+		}
+	};
+} // namespace std
+
+#endif // LIBSUGARX_STRING_POOL_H
@@ -1,8 +1,19 @@
 #ifndef LIBSUGARX_UUID_H
 #define LIBSUGARX_UUID_H
 
+#include <algorithm>
 #include <array>
-#include <charconv>
+#include <atomic>
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "sugar_digest.h"
+#include "sugar_endian.h"
 #include "sugar_string.h"
 
 namespace libsugarx
@@ -21,6 +32,10 @@ namespace libsugarx
 
 	class uuid
 	{
+		friend class uuid_generator;
+		friend class uuid_v7_generator;
+		friend class uuid_name_generator;
+
 		std::array<std::byte, 16> data{};
 
 		constexpr void set_version_and_variant(int version)
@@ -29,6 +44,84 @@ namespace libsugarx
 			data[8] = std::byte((static_cast<unsigned char>(data[8]) & 0x3F) | 0x80);
 		}
 
+		template<typename Digest>
+		static constexpr uuid name_based(const Digest &digest, int version) noexcept
+		{
+			uuid result;
+			typename Digest::digest_type hash = digest.finish();
+			std::copy_n(hash.begin(), result.data.size(), result.data.begin());
+			result.set_version_and_variant(version);
+			return result;
+		}
+
+		// where the 8-4-4-4-12 hex groups sit in the 32 hex digits and in the text
+		struct text_group
+		{
+			std::size_t hex;
+			std::size_t text;
+			std::size_t length;
+		};
+
+		static constexpr std::array<text_group, 5> groups{{{0, 0, 8}, {8, 9, 4}, {12, 14, 4}, {16, 19, 4}, {20, 24, 12}}};
+		static constexpr std::array<std::size_t, 4> dashes{8, 13, 18, 23};
+
+		// the 32 hex digits of a 36-char uuid into out, false on a non-hex digit
+		static constexpr bool parse_hex(const char *in, std::array<std::byte, 16> &out) noexcept
+		{
+			if !consteval
+			{
+#if defined(LIBSUGARX_HAS_SSSE3)
+				return parse_simd(in, out.data());
+#endif
+			}
+			std::array<char, 32> hex{};
+			for(const text_group &group : groups)
+				std::copy_n(in + group.text, group.length, hex.begin() + group.hex);
+			return hex_codec::decode(std::string_view(hex.data(), hex.size()), out) == hex_error::none;
+		}
+
+#if defined(LIBSUGARX_HAS_SSSE3)
+		// hex_codec encodes, two shuffles put the dashes in
+		void format_simd(char *out) const noexcept
+		{
+			alignas(16) char hex[32];
+			hex_codec::encode(data, std::span<char>(hex, 32));
+			__m128i first = _mm_load_si128(reinterpret_cast<const __m128i *>(hex));
+			__m128i second = _mm_load_si128(reinterpret_cast<const __m128i *>(hex + 16));
+
+			// out[0, 16) = first[0, 8) - first[8, 12) - first[12, 14)
+			__m128i head = _mm_or_si128(_mm_shuffle_epi8(first, _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, -1, 8, 9, 10, 11, -1, 12, 13)),
+				_mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, '-', 0, 0, 0, 0, '-', 0, 0));
+			// out[16, 32) = first[14, 16) - second[0, 4) - second[4, 12)
+			__m128i middle = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(first, _mm_setr_epi8(14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+				_mm_shuffle_epi8(second, _mm_setr_epi8(-1, -1, -1, 0, 1, 2, 3, -1, 4, 5, 6, 7, 8, 9, 10, 11))),
+				_mm_setr_epi8(0, 0, '-', 0, 0, 0, 0, '-', 0, 0, 0, 0, 0, 0, 0, 0));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out), head);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), middle);
+			std::memcpy(out + 32, hex + 28, 4);
+		}
+
+		// two shuffles drop the dashes, hex_codec decodes, reads exactly 36 chars
+		static bool parse_simd(const char *in, std::byte *out) noexcept
+		{
+			__m128i text_0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+			__m128i text_16 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 16));
+			__m128i text_20 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 20));
+
+			// in[0, 8) in[9, 13) in[14, 18)
+			__m128i first = _mm_or_si128(_mm_shuffle_epi8(text_0, _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 9, 10, 11, 12, 14, 15, -1, -1)),
+				_mm_shuffle_epi8(text_16, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 1)));
+			// in[19, 23) in[24, 36)
+			__m128i second = _mm_or_si128(_mm_shuffle_epi8(text_16, _mm_setr_epi8(3, 4, 5, 6, 8, 9, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1)),
+				_mm_shuffle_epi8(text_20, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 12, 13, 14, 15)));
+
+			alignas(16) char hex[32];
+			_mm_store_si128(reinterpret_cast<__m128i *>(hex), first);
+			_mm_store_si128(reinterpret_cast<__m128i *>(hex + 16), second);
+			return hex_codec::decode(std::string_view(hex, 32), data_span(out, 16)) == hex_error::none;
+		}
+#endif
+
 	public:
 		constexpr uuid() = default;
 		constexpr uuid(uuid_string str)
@@ -41,83 +134,137 @@ namespace libsugarx
 
 		static uuid generate_v1() = delete;
 		static uuid generate_v2() = delete;
-		// MD5 based
-		static uuid generate_v3(std::string_view name, uuid name_space);
+		// MD5 based, constexpr
+		static constexpr uuid generate_v3(std::string_view name, uuid name_space)
+		{
+			return name_based(md5().update(name_space.data).update(name), 3);
+		}
 		// random + return optional
 		static std::optional<uuid> generate_v4_optional();
 		// random + return nullable
 		static uuid generate_v4_nullable();
-		// Sha256 based
-		static uuid generate_v5(std::string_view name, uuid name_space);
+		// SHA-1 based, constexpr
+		static constexpr uuid generate_v5(std::string_view name, uuid name_space)
+		{
+			return name_based(sha1().update(name_space.data).update(name), 5);
+		}
 		static uuid generate_v6() = delete;
-		// timestamp + random + return optional
+		// timestamp + random + return optional, ordered by uuid_v7_generator::shared()
 		static std::optional<uuid> generate_v7_optional();
-		// timestamp + random + return nullable
+		// timestamp + random + return nullable, ordered by uuid_v7_generator::shared()
 		static uuid generate_v7_nullable();
+		// fills out from the calling thread's uuid_generator, false if the random source failed
+		static bool generate_v4_batch(std::span<uuid> out);
+		static bool generate_v7_batch(std::span<uuid> out);
+
+		/*
+		writes the 36-char canonical form, lowercase and without a terminator.
+		*/
+		constexpr void to_chars(std::span<char, 36> out) const noexcept
+		{
+			if !consteval
+			{
+#if defined(LIBSUGARX_HAS_SSSE3)
+				format_simd(out.data());
+				return;
+#endif
+			}
+			std::array<char, 32> hex{};
+			hex_codec::encode(data, hex);
+			for(const text_group &group : groups)
+				std::copy_n(hex.begin() + group.hex, group.length, out.begin() + group.text);
+			for(std::size_t dash : dashes)
+				out[dash] = '-';
+		}
 
 		constexpr uuid_string to_string() const
 		{
 			uuid_string str;
-			string_append_byte(str, data[0]);
-			string_append_byte(str, data[1]);
-			string_append_byte(str, data[2]);
-			string_append_byte(str, data[3]);
-			str.concat('-');
-			string_append_byte(str, data[4]);
-			string_append_byte(str, data[5]);
-			str.concat('-');
-			string_append_byte(str, data[6]);
-			string_append_byte(str, data[7]);
-			str.concat('-');
-			string_append_byte(str, data[8]);
-			string_append_byte(str, data[9]);
-			str.concat('-');
-			string_append_byte(str, data[10]);
-			string_append_byte(str, data[11]);
-			string_append_byte(str, data[12]);
-			string_append_byte(str, data[13]);
-			string_append_byte(str, data[14]);
-			string_append_byte(str, data[15]);
+			to_chars(std::span<char, 36>(str.data(), 36));
+			str.resize(36);
 			return str;
 		}
 
-		// return uuid_error::none on success
-		constexpr uuid_error from_string(const uuid_string &str)
+		// return uuid_error::none on success, takes either case
+		constexpr uuid_error from_string(std::string_view str) noexcept
 		{
-			if(str.length() != 36)
+			if(str.size() != 36)
 				return uuid_error::length;
 
-			if(str[8] != '-' || str[13] != '-' || str[18] != '-' || str[23] != '-')
-				return uuid_error::format;
-
-			std::array<char, 32> hex_chars{};
-			size_t out_idx = 0;
-			for(size_t i = 0; i < 36; ++i)
+			for(std::size_t dash : dashes)
 			{
-				if(str[i] == '-') continue;
-				if(out_idx >= 32)
-					return uuid_error::too_many_digits;
-				hex_chars[out_idx++] = str[i];
+				if(str[dash] != '-')
+					return uuid_error::format;
 			}
 
-			if(out_idx != 32)
-				return uuid_error::too_few_digits;
-
 			std::array<std::byte, 16> temp{};
-			for(size_t i = 0; i < 16; ++i)
+			if(!parse_hex(str.data(), temp))
 			{
-				int value;
-				auto result = std::from_chars(&hex_chars[i * 2], &hex_chars[i * 2] + 2, value, 16);
-				if(result.ec != std::errc{} && result.ptr == (&hex_chars[i * 2] + 2))
-					return uuid_error::invalid_char;
-
-				temp[i] = static_cast<std::byte>(value);
+				for(const text_group &group : groups)
+				{
+					if(str.substr(group.text, group.length).find('-') != std::string_view::npos)
+						return uuid_error::too_few_digits;
+				}
+				return uuid_error::invalid_char;
 			}
 			data = temp;
 			return uuid_error::none;
 		}
 
-		auto operator<=>(const uuid &other) const = default;
+		/*
+		the bytes as two big-endian words, comparing {high, low} orders like the bytes.
+		*/
+		constexpr std::array<std::uint64_t, 2> words() const noexcept
+		{
+			if consteval
+			{
+				std::array<std::uint64_t, 2> result{};
+				for(std::size_t i = 0; i < 16; ++i)
+					result[i / 8] = (result[i / 8] << 8) | static_cast<unsigned char>(data[i]);
+				return result;
+			}
+			else
+			{
+				std::array<std::uint64_t, 2> result;
+				std::memcpy(result.data(), data.data(), data.size());
+				return {to_big_endian(result[0]), to_big_endian(result[1])};
+			}
+		}
+
+		constexpr bool is_null() const noexcept
+		{
+			std::array<std::uint64_t, 2> w = words();
+			return (w[0] | w[1]) == 0;
+		}
+
+		// one 128-bit compare at runtime
+		constexpr bool operator==(const uuid &other) const noexcept
+		{
+			if consteval
+			{
+				return data == other.data;
+			}
+			else
+			{
+#if defined(LIBSUGARX_HAS_SSE2)
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data.data()));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(other.data.data()));
+				return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF;
+#else
+				return std::memcmp(data.data(), other.data.data(), data.size()) == 0;
+#endif
+			}
+		}
+
+		// same order as comparing the bytes, two word compares instead of 16 byte compares
+		constexpr std::strong_ordering operator<=>(const uuid &other) const noexcept
+		{
+			std::array<std::uint64_t, 2> a = words();
+			std::array<std::uint64_t, 2> b = other.words();
+			if(a[0] != b[0])
+				return a[0] <=> b[0];
+			return a[1] <=> b[1];
+		}
 
 		static constexpr const uuid &null()
 		{
@@ -126,10 +273,24 @@ namespace libsugarx
 		}
 	};
 
+	/*
+	struct uuid_hash
+	folds the two 64-bit halves with one 64x64->128 multiply.
+	v4 bits are random already, the multiply still spreads a v7 timestamp and counter over every bit.
+	*/
+	struct uuid_hash
+	{
+		constexpr std::size_t operator()(const uuid &id) const noexcept
+		{
+			std::array<std::uint64_t, 2> w = id.words();
+			return static_cast<std::size_t>(wide_string_hash::mul_fold(w[0] ^ 0x9E3779B97F4A7C15ULL, w[1] ^ 0xC2B2AE3D27D4EB4FULL));
+		}
+	};
+
 	constexpr uuid uuid_from_string_nullable(const uuid_string &str)
 	{
 		uuid result(str);
-		return str;
+		return result;
 	}
 
 	constexpr std::optional<uuid> uuid_from_string_optional(const uuid_string &str)
@@ -139,6 +300,219 @@ namespace libsugarx
 			return std::nullopt;
 		return result;
 	}
+
+	struct uuid_parse_result
+	{
+		// elements written to out
+		std::size_t count = 0;
+		// elements of those that failed to parse
+		std::size_t failed = 0;
+		// chars of text read, resume from here when out was full
+		std::size_t consumed = 0;
+	};
+
+	/*
+	parses a list of uuids separated by '\n' or ',' ("\r\n" works too) into out, one element per field.
+	a trailing delimiter doesn't start another field.
+	errors gets each element's uuid_error when it's big enough, elements that failed are set to null.
+	*/
+	constexpr uuid_parse_result uuid_parse_many(std::string_view text, std::span<uuid> out, std::span<uuid_error> errors = {}) noexcept
+	{
+		uuid_parse_result result;
+		std::size_t pos = 0;
+		while(pos < text.size() && result.count < out.size())
+		{
+			// canonical fields end right after 36 chars, no need to scan for it
+			std::size_t end = pos + 36;
+			if(end > text.size() || (end < text.size() && text[end] != '\n' && text[end] != ','))
+			{
+				end = string_search::find_first_of(text, "\n,", pos);
+				if(end == std::string_view::npos)
+					end = text.size();
+			}
+
+			std::string_view field = text.substr(pos, end - pos);
+			if(!field.empty() && field.back() == '\r')
+				field.remove_suffix(1);
+
+			uuid_error error = out[result.count].from_string(field);
+			if(error != uuid_error::none)
+			{
+				out[result.count] = uuid();
+				++result.failed;
+			}
+			if(result.count < errors.size())
+				errors[result.count] = error;
+			++result.count;
+			pos = std::min(end + 1, text.size());
+		}
+		result.consumed = pos;
+		return result;
+	}
+
+	/*
+	writes each uuid followed by delimiter, as many as fit in out.
+	returns the number of chars written, 37 per uuid.
+	*/
+	constexpr std::size_t uuid_format_many(std::span<const uuid> ids, std::span<char> out, char delimiter = '\n') noexcept
+	{
+		std::size_t count = std::min(ids.size(), out.size() / 37);
+		for(std::size_t i = 0; i < count; ++i)
+		{
+			ids[i].to_chars(std::span<char, 36>(out.data() + 37 * i, 36));
+			out[37 * i + 36] = delimiter;
+		}
+		return 37 * count;
+	}
+
+	/*
+	class uuid_generator
+	hands out v4/v7 UUIDs from a block of RAND_bytes output,
+	so the DRBG lock is taken once per block instead of once per UUID.
+	not thread-safe, keep one per thread or use thread_local_generator().
+	the block is refilled after fork(), parent and child never share random bytes.
+	*/
+	class uuid_generator
+	{
+	public:
+		static constexpr std::size_t block_size = 4096;
+		// batches at least this big are filled by RAND_bytes directly
+		static constexpr std::size_t direct_batch = block_size / sizeof(uuid);
+
+		uuid_generator();
+		~uuid_generator();
+
+		uuid_generator(const uuid_generator &other) = delete;
+		uuid_generator &operator=(const uuid_generator &other) = delete;
+
+		std::optional<uuid> generate_v4();
+		// ordered by uuid_v7_generator::shared(), random bits from this generator
+		std::optional<uuid> generate_v7();
+
+		// false if the random source failed, out is then only partly filled
+		bool generate_v4_batch(std::span<uuid> out);
+		bool generate_v7_batch(std::span<uuid> out);
+
+		static uuid_generator &thread_local_generator();
+
+	private:
+		friend class uuid_v7_generator;
+
+		bool take(std::byte *out, std::size_t size);
+		bool refill();
+
+		std::array<std::byte, block_size> block_;
+		std::size_t used_ = block_size;
+		std::uint64_t fork_generation_ = 0;
+	};
+
+	/*
+	class uuid_v7_generator
+	strictly increasing UUIDv7s (RFC 9562 6.2, methods 1 and 3) without a lock.
+	the 48-bit millisecond timestamp, a 12-bit sub-millisecond fraction in rand_a
+	and a 4-bit counter in the top of rand_b form one 64-bit state,
+	every UUID claims the next state with a single CAS or fetch_add.
+	counter overflow carries into the fraction and the timestamp,
+	so under bursts or after the clock goes backwards the timestamp runs ahead of the clock
+	until the clock catches up, it never repeats or goes back.
+	the remaining 58 bits of rand_b are random.
+	*/
+	class uuid_v7_generator
+	{
+	public:
+		uuid_v7_generator() = default;
+
+		uuid_v7_generator(const uuid_v7_generator &other) = delete;
+		uuid_v7_generator &operator=(const uuid_v7_generator &other) = delete;
+
+		std::optional<uuid> generate(uuid_generator &random = uuid_generator::thread_local_generator());
+		// out is ordered and claims its states in one step, false if the random source failed
+		bool generate_batch(std::span<uuid> out, uuid_generator &random = uuid_generator::thread_local_generator());
+
+		// the process-wide generator behind uuid::generate_v7_*
+		static uuid_v7_generator &shared();
+
+	private:
+		static constexpr int counter_bits = 4;
+		static constexpr int fraction_bits = 12;
+
+		std::uint64_t reserve(std::uint64_t count);
+		static void fill(uuid &target, std::uint64_t state);
+
+		// 48-bit ms | 12-bit fraction | 4-bit counter
+		alignas(64) std::atomic<std::uint64_t> state_{0};
+	};
+
+	/*
+	class uuid_name_generator
+	v3 (MD5) or v5 (SHA-1) UUIDs for many names under one namespace.
+	the namespace is absorbed once, each name continues from a copy of that digest state,
+	so generating allocates nothing and can run at compile time.
+	generate is const and thread-safe, batches of parallel_batch names or more are split over threads.
+	*/
+	class uuid_name_generator
+	{
+	public:
+		static constexpr std::size_t parallel_batch = 1 << 14;
+
+		// version is 3 or 5, throws std::invalid_argument for others
+		constexpr uuid_name_generator(uuid name_space, int version) : version_(version)
+		{
+			if(version != 3 && version != 5)
+				throw std::invalid_argument("uuid_name_generator: version must be 3 or 5");
+			if(version == 3)
+				md5_.update(name_space.data);
+			else
+				sha1_.update(name_space.data);
+		}
+
+		constexpr uuid generate(std::string_view name) const noexcept
+		{
+			if(version_ == 3)
+				return uuid::name_based(md5(md5_).update(name), 3);
+			return uuid::name_based(sha1(sha1_).update(name), 5);
+		}
+
+		// out[i] from names[i], returns how many were generated
+		std::size_t generate(std::span<const std::string_view> names, std::span<uuid> out) const
+		{
+			std::size_t count = std::min(names.size(), out.size());
+			std::size_t threads = std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 1U), count / (parallel_batch / 4) + 1);
+			if(count < parallel_batch || threads < 2)
+			{
+				generate_range(names.first(count), out.first(count));
+				return count;
+			}
+
+			std::vector<std::jthread> workers;
+			std::size_t per_thread = (count + threads - 1) / threads;
+			for(std::size_t begin = 0; begin < count; begin += per_thread)
+			{
+				std::size_t length = std::min(per_thread, count - begin);
+				workers.emplace_back([this, names, out, begin, length] { generate_range(names.subspan(begin, length), out.subspan(begin, length)); });
+			}
+			return count;
+		}
+
+		constexpr int version() const noexcept { return version_; }
+
+	private:
+		constexpr void generate_range(std::span<const std::string_view> names, std::span<uuid> out) const noexcept
+		{
+			for(std::size_t i = 0; i < names.size(); ++i)
+				out[i] = generate(names[i]);
+		}
+
+		md5 md5_;
+		sha1 sha1_;
+		int version_;
+	};
+
+	// the well-known namespaces of RFC 9562
+	inline constexpr uuid uuid_namespace_dns(uuid_string("6ba7b810-9dad-11d1-80b4-00c04fd430c8"));
+	inline constexpr uuid uuid_namespace_url(uuid_string("6ba7b811-9dad-11d1-80b4-00c04fd430c8"));
+	inline constexpr uuid uuid_namespace_oid(uuid_string("6ba7b812-9dad-11d1-80b4-00c04fd430c8"));
+	inline constexpr uuid uuid_namespace_x500(uuid_string("6ba7b814-9dad-11d1-80b4-00c04fd430c8"));
 } // namespace libsugarx
 
 namespace std
@@ -163,7 +537,7 @@ namespace std
 	{
 		size_t operator()(const libsugarx::uuid &uuid) const noexcept
 		{
-			return std::hash<std::string_view>{}({reinterpret_cast<const char *>(uuid.raw_data().data()), uuid.raw_data().size()});
+			return libsugarx::uuid_hash{}(uuid);
 		}
 	};
 } // namespace std
@@ -172,106 +546,238 @@ namespace std
 
 #ifdef LIBSUGARX_UUID_GENERATION_IMPL
 
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <mutex>
 
-#include <openssl/evp.h>
+#include <openssl/crypto.h>
 #include <openssl/rand.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#endif
+
 namespace libsugarx
 {
-	uuid uuid::generate_v3(std::string_view name, uuid name_space)
+	std::optional<uuid> uuid::generate_v4_optional()
 	{
-		uuid result;
-		EVP_MD_CTX *ctx = EVP_MD_CTX_new();
-		std::array<std::byte, EVP_MAX_MD_SIZE> digest;
+		return uuid_generator::thread_local_generator().generate_v4();
+	}
 
-		EVP_DigestInit(ctx, EVP_md5());
-		EVP_DigestUpdate(ctx, name_space.data.data(), name_space.data.size());
-		EVP_DigestUpdate(ctx, name.data(), name.size());
-		EVP_DigestFinal(ctx, reinterpret_cast<unsigned char *>(digest.data()), nullptr);
-		EVP_MD_CTX_free(ctx);
+	uuid uuid::generate_v4_nullable()
+	{
+		return generate_v4_optional().value_or(null());
+	}
 
-		for(std::size_t i = 0; i < result.data.size(); i++)
-			result.data[i] = digest[i];
+	bool uuid::generate_v4_batch(std::span<uuid> out)
+	{
+		return uuid_generator::thread_local_generator().generate_v4_batch(out);
+	}
 
-		result.set_version_and_variant(3);
-		return result;
+	std::optional<uuid> uuid::generate_v7_optional()
+	{
+		return uuid_v7_generator::shared().generate();
 	}
 
-	std::optional<uuid> uuid::generate_v4_optional()
+	uuid uuid::generate_v7_nullable()
+	{
+		return generate_v7_optional().value_or(null());
+	}
+
+	bool uuid::generate_v7_batch(std::span<uuid> out)
+	{
+		return uuid_v7_generator::shared().generate_batch(out);
+	}
+
+	namespace
+	{
+		// bumped in every forked child, generators refill when it moves
+		std::atomic<std::uint64_t> fork_generation{0};
+
+		void watch_forks()
+		{
+#if defined(__unix__) || defined(__APPLE__)
+			static std::once_flag registered;
+			std::call_once(registered, [] {
+				pthread_atfork(nullptr, nullptr, [] { fork_generation.fetch_add(1, std::memory_order_relaxed); });
+			});
+#endif
+		}
+
+		// RFC 9562 unix_ts_ms is Unix time, without leap seconds
+		std::uint64_t unix_time_ns()
+		{
+			return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+		}
+
+		bool random_bytes(void *out, std::size_t size)
+		{
+			// RAND_bytes takes an int length
+			for(auto *bytes = static_cast<unsigned char *>(out); size > 0;)
+			{
+				int chunk = static_cast<int>(std::min<std::size_t>(size, 1 << 30));
+				if(RAND_bytes(bytes, chunk) != 1)
+					return false;
+				bytes += chunk;
+				size -= static_cast<std::size_t>(chunk);
+			}
+			return true;
+		}
+	} // namespace
+
+	uuid_generator::uuid_generator()
+	{
+		watch_forks();
+	}
+
+	uuid_generator::~uuid_generator()
+	{
+		OPENSSL_cleanse(block_.data(), block_.size());
+	}
+
+	uuid_generator &uuid_generator::thread_local_generator()
+	{
+		thread_local uuid_generator generator;
+		return generator;
+	}
+
+	bool uuid_generator::refill()
+	{
+		if(!random_bytes(block_.data(), block_.size()))
+		{
+			used_ = block_.size();
+			return false;
+		}
+		used_ = 0;
+		fork_generation_ = fork_generation.load(std::memory_order_relaxed);
+		return true;
+	}
+
+	bool uuid_generator::take(std::byte *out, std::size_t size)
+	{
+		if(used_ + size > block_.size() || fork_generation_ != fork_generation.load(std::memory_order_relaxed))
+		{
+			if(!refill())
+				return false;
+		}
+		std::memcpy(out, block_.data() + used_, size);
+		// handed out bytes are not kept around
+		std::memset(block_.data() + used_, 0, size);
+		used_ += size;
+		return true;
+	}
+
+	std::optional<uuid> uuid_generator::generate_v4()
 	{
 		uuid result;
-		if(RAND_bytes(reinterpret_cast<unsigned char *>(result.data.data()), result.data.size()) != 1)
+		if(!take(result.data.data(), result.data.size()))
 			return std::nullopt;
 		result.set_version_and_variant(4);
 		return result;
 	}
 
-	uuid uuid::generate_v4_nullable()
+	std::optional<uuid> uuid_generator::generate_v7()
 	{
-		uuid result;
-		if(RAND_bytes(reinterpret_cast<unsigned char *>(result.data.data()), result.data.size()) != 1)
-			return null();
-		result.set_version_and_variant(4);
-		return result;
+		return uuid_v7_generator::shared().generate(*this);
 	}
 
-	uuid uuid::generate_v5(std::string_view name, uuid name_space)
+	bool uuid_generator::generate_v4_batch(std::span<uuid> out)
 	{
-		uuid result;
-		EVP_MD_CTX *ctx = EVP_MD_CTX_new();
-		std::array<std::byte, EVP_MAX_MD_SIZE> digest;
-
-		EVP_DigestInit(ctx, EVP_sha1());
-		EVP_DigestUpdate(ctx, name_space.data.data(), name_space.data.size());
-		EVP_DigestUpdate(ctx, name.data(), name.size());
-		EVP_DigestFinal(ctx, reinterpret_cast<unsigned char *>(digest.data()), nullptr);
-		EVP_MD_CTX_free(ctx);
-
-		for(std::size_t i = 0; i < result.data.size(); i++)
-			result.data[i] = digest[i];
-		result.set_version_and_variant(5);
-		return result;
+		if(out.size() >= direct_batch)
+		{
+			if(!random_bytes(out.data(), out.size_bytes()))
+				return false;
+		}
+		else
+		{
+			for(uuid &target : out)
+			{
+				if(!take(target.data.data(), target.data.size()))
+					return false;
+			}
+		}
+		for(uuid &target : out)
+			target.set_version_and_variant(4);
+		return true;
 	}
 
-	std::optional<uuid> uuid::generate_v7_optional()
+	bool uuid_generator::generate_v7_batch(std::span<uuid> out)
 	{
-		uuid result;
-		int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::utc_clock::now().time_since_epoch()).count();
+		return uuid_v7_generator::shared().generate_batch(out, *this);
+	}
 
-		uint64_t timestamp = static_cast<uint64_t>(now_ms) & 0xFFFFFFFFFFFFULL; // 48 bits
-		result.data[0] = std::byte((timestamp >> 40) & 0xFF);
-		result.data[1] = std::byte((timestamp >> 32) & 0xFF);
-		result.data[2] = std::byte((timestamp >> 24) & 0xFF);
-		result.data[3] = std::byte((timestamp >> 16) & 0xFF);
-		result.data[4] = std::byte((timestamp >> 8) & 0xFF);
-		result.data[5] = std::byte(timestamp & 0xFF);
+	uuid_v7_generator &uuid_v7_generator::shared()
+	{
+		static uuid_v7_generator generator;
+		return generator;
+	}
 
-		if(RAND_bytes(reinterpret_cast<unsigned char *>(result.data.data() + 6), 10) != 1)
-			return std::nullopt;
+	std::uint64_t uuid_v7_generator::reserve(std::uint64_t count)
+	{
+		std::uint64_t ns = unix_time_ns();
+		std::uint64_t ms = ns / 1000000;
+		std::uint64_t fraction = (ns % 1000000) * (1 << fraction_bits) / 1000000;
+		std::uint64_t now = (((ms << fraction_bits) | fraction) << counter_bits);
 
-		result.set_version_and_variant(7);
-		return result;
+		std::uint64_t current = state_.load(std::memory_order_relaxed);
+		while(now > current)
+		{
+			if(state_.compare_exchange_weak(current, now + count - 1, std::memory_order_relaxed))
+				return now;
+		}
+		// clock hasn't moved past the last state, count on from it
+		return state_.fetch_add(count, std::memory_order_relaxed) + 1;
 	}
 
-	uuid uuid::generate_v7_nullable()
+	void uuid_v7_generator::fill(uuid &target, std::uint64_t state)
 	{
-		uuid result;
-		int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::utc_clock::now().time_since_epoch()).count();
+		std::uint64_t ms = state >> (fraction_bits + counter_bits);
+		std::uint64_t fraction = (state >> counter_bits) & ((1 << fraction_bits) - 1);
+		std::uint64_t counter = state & ((1 << counter_bits) - 1);
+		target.data[0] = std::byte((ms >> 40) & 0xFF);
+		target.data[1] = std::byte((ms >> 32) & 0xFF);
+		target.data[2] = std::byte((ms >> 24) & 0xFF);
+		target.data[3] = std::byte((ms >> 16) & 0xFF);
+		target.data[4] = std::byte((ms >> 8) & 0xFF);
+		target.data[5] = std::byte(ms & 0xFF);
+		target.data[6] = std::byte(0x70 | (fraction >> 8));
+		target.data[7] = std::byte(fraction & 0xFF);
+		// variant, then the counter, then 2 random bits
+		target.data[8] = std::byte(0x80 | (counter << 2) | (static_cast<unsigned>(target.data[8]) & 0x03));
+	}
 
-		uint64_t timestamp = static_cast<uint64_t>(now_ms) & 0xFFFFFFFFFFFFULL; // 48 bits
-		result.data[0] = std::byte((timestamp >> 40) & 0xFF);
-		result.data[1] = std::byte((timestamp >> 32) & 0xFF);
-		result.data[2] = std::byte((timestamp >> 24) & 0xFF);
-		result.data[3] = std::byte((timestamp >> 16) & 0xFF);
-		result.data[4] = std::byte((timestamp >> 8) & 0xFF);
-		result.data[5] = std::byte(timestamp & 0xFF);
+	std::optional<uuid> uuid_v7_generator::generate(uuid_generator &random)
+	{
+		uuid result;
+		if(!random.take(result.data.data() + 8, 8))
+			return std::nullopt;
+		fill(result, reserve(1));
+		return result;
+	}
 
-		if(RAND_bytes(reinterpret_cast<unsigned char *>(result.data.data() + 6), 10) != 1)
-			return null();
+	bool uuid_v7_generator::generate_batch(std::span<uuid> out, uuid_generator &random)
+	{
+		if(out.empty())
+			return true;
+		if(out.size() >= uuid_generator::direct_batch)
+		{
+			if(!random_bytes(out.data(), out.size_bytes()))
+				return false;
+		}
+		else
+		{
+			for(uuid &target : out)
+			{
+				if(!random.take(target.data.data() + 8, 8))
+					return false;
+			}
+		}
 
-		result.set_version_and_variant(7);
-		return result;
+		std::uint64_t first = reserve(out.size());
+		for(std::size_t i = 0; i < out.size(); ++i)
+			fill(out[i], first + i);
+		return true;
 	}
 }; // namespace libsugarx
 
@@ -0,0 +1,368 @@
+#ifndef LIBSUGARX_UUID_TABLE_H
+#define LIBSUGARX_UUID_TABLE_H
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sugar_uuid.h"
+
+namespace libsugarx
+{
+	/*
+	class basic_uuid_table
+	open-addressing table keyed by uuid, keys live inline in the slots, no control bytes.
+	the null uuid marks an empty slot, a null key itself is kept aside.
+	linear probing from uuid_hash, removal shifts the run back so there are no tombstones.
+	Value = void makes it a set.
+	not thread safe
+	*/
+	template<typename Value, typename Allocator = std::allocator<std::byte>>
+	class basic_uuid_table
+	{
+		template<typename T>
+		using rebind_alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+		static constexpr bool is_set = std::is_void_v<Value>;
+
+		struct map_slot
+		{
+			uuid key;
+			Value value{};
+		};
+
+	public:
+		// a set's slots are bare keys
+		using slot_type = std::conditional_t<is_set, uuid, map_slot>;
+		using allocator_type = Allocator;
+		using value_reference = std::add_lvalue_reference_t<Value>;
+		using const_value_reference = std::add_lvalue_reference_t<const Value>;
+
+		basic_uuid_table() = default;
+
+		explicit basic_uuid_table(const Allocator &alloc) : slots_(alloc) {}
+
+		allocator_type get_allocator() const noexcept { return allocator_type(slots_.get_allocator()); }
+
+		/*
+		returns false if key is already in the set.
+		*/
+		bool insert(const uuid &key)
+		requires is_set
+		{
+			return insert_slot(key).second;
+		}
+
+		template<typename... Args>
+		requires(!is_set)
+		/*
+		one probe for both lookup and insertion.
+		returns the existing value and false if key is already in use.
+		if Value's constructor throws, the key is taken out again.
+		*/
+		std::pair<std::reference_wrapper<Value>, bool> try_emplace(const uuid &key, Args &&...args)
+		{
+			auto [slot, inserted] = insert_slot(key);
+			if(inserted)
+			{
+				try
+				{
+					slot->value = Value(std::forward<Args>(args)...);
+				}
+				catch(...)
+				{
+					erase_slot(slot);
+					throw;
+				}
+			}
+			return {std::ref(slot->value), inserted};
+		}
+
+		template<typename... Args>
+		requires(!is_set)
+		/*
+		need to check if return value is available.
+		*/
+		std::optional<std::reference_wrapper<Value>> emplace(const uuid &key, Args &&...args)
+		{
+			auto [result, inserted] = try_emplace(key, std::forward<Args>(args)...);
+			if(!inserted)
+				return std::nullopt;
+			return result;
+		}
+
+		std::optional<std::reference_wrapper<Value>> find(const uuid &key) noexcept
+		requires(!is_set)
+		{
+			slot_type *slot = find_slot(key);
+			if(!slot)
+				return std::nullopt;
+			return std::ref(slot->value);
+		}
+
+		std::optional<std::reference_wrapper<const Value>> find(const uuid &key) const noexcept
+		requires(!is_set)
+		{
+			const slot_type *slot = find_slot(key);
+			if(!slot)
+				return std::nullopt;
+			return std::cref(slot->value);
+		}
+
+		/*
+		this is a C-style method, which means it wouldn't create new object automatically.
+		*/
+		value_reference operator[](const uuid &key)
+		requires(!is_set)
+		{
+			return at(key);
+		}
+
+		value_reference at(const uuid &key)
+		requires(!is_set)
+		{
+			slot_type *slot = find_slot(key);
+			if(!slot)
+				throw std::out_of_range("Key not found");
+			return slot->value;
+		}
+
+		const_value_reference at(const uuid &key) const
+		requires(!is_set)
+		{
+			const slot_type *slot = find_slot(key);
+			if(!slot)
+				throw std::out_of_range("Key not found");
+			return slot->value;
+		}
+
+		bool contains(const uuid &key) const noexcept { return find_slot(key) != nullptr; }
+
+		/*
+		returns true as the key existed.
+		*/
+		bool remove(const uuid &key)
+		{
+			slot_type *slot = find_slot(key);
+			if(!slot)
+				return false;
+			erase_slot(slot);
+			return true;
+		}
+
+		void clear()
+		{
+			std::fill(slots_.begin(), slots_.end(), slot_type{});
+			null_slot_ = slot_type{};
+			has_null_ = false;
+			size_ = 0;
+		}
+
+		/*
+		makes room for size keys without growing.
+		*/
+		void reserve(std::size_t size)
+		{
+			std::size_t needed = std::bit_ceil(std::max<std::size_t>(size + size / 3 + 1, min_capacity));
+			if(needed > slots_.size())
+				rehash(needed);
+		}
+
+		std::size_t size() const noexcept { return size_; }
+		bool empty() const noexcept { return size_ == 0; }
+		std::size_t capacity() const noexcept { return slots_.size(); }
+
+		/*
+		bytes held by the slot array,
+		memory owned by values themselves is not included.
+		*/
+		std::size_t allocated_bytes() const noexcept { return slots_.capacity() * sizeof(slot_type); }
+
+		/*
+		fn(const uuid &) for a set, fn(const uuid &, Value &) for a map, in slot order.
+		*/
+		template<typename Fn>
+		void for_each(Fn &&fn)
+		{
+			for_each_slot(*this, fn);
+		}
+
+		template<typename Fn>
+		void for_each(Fn &&fn) const
+		{
+			for_each_slot(*this, fn);
+		}
+
+	private:
+		static constexpr std::size_t min_capacity = 16;
+
+		static constexpr const uuid &key_of(const slot_type &slot) noexcept
+		{
+			if constexpr(is_set)
+				return slot;
+			else
+				return slot.key;
+		}
+
+		static constexpr uuid &key_of(slot_type &slot) noexcept
+		{
+			if constexpr(is_set)
+				return slot;
+			else
+				return slot.key;
+		}
+
+		std::size_t home_of(const uuid &key) const noexcept
+		{
+			return uuid_hash{}(key) & (slots_.size() - 1);
+		}
+
+		template<typename Self>
+		static auto find_slot_in(Self &self, const uuid &key) noexcept
+		{
+			using pointer = decltype(&self.null_slot_);
+			if(key.is_null())
+				return self.has_null_ ? &self.null_slot_ : pointer{nullptr};
+			if(self.slots_.empty())
+				return pointer{nullptr};
+
+			std::size_t mask = self.slots_.size() - 1;
+			for(std::size_t pos = self.home_of(key);; pos = (pos + 1) & mask)
+			{
+				const uuid &current = key_of(self.slots_[pos]);
+				if(current == key)
+					return &self.slots_[pos];
+				if(current.is_null())
+					return pointer{nullptr};
+			}
+		}
+
+		slot_type *find_slot(const uuid &key) noexcept { return find_slot_in(*this, key); }
+		const slot_type *find_slot(const uuid &key) const noexcept { return find_slot_in(*this, key); }
+
+		std::pair<slot_type *, bool> insert_slot(const uuid &key)
+		{
+			if(key.is_null())
+			{
+				bool inserted = !has_null_;
+				if(inserted)
+				{
+					has_null_ = true;
+					++size_;
+				}
+				return {&null_slot_, inserted};
+			}
+			// a load factor of 3/4 keeps linear probe runs short
+			if(slots_.empty() || (size_ + 1) * 4 > slots_.size() * 3)
+				rehash(std::max(slots_.size() * 2, min_capacity));
+
+			std::size_t mask = slots_.size() - 1;
+			for(std::size_t pos = home_of(key);; pos = (pos + 1) & mask)
+			{
+				uuid &current = key_of(slots_[pos]);
+				if(current == key)
+					return {&slots_[pos], false};
+				if(current.is_null())
+				{
+					current = key;
+					++size_;
+					return {&slots_[pos], true};
+				}
+			}
+		}
+
+		void erase_slot(slot_type *slot)
+		{
+			if(slot == &null_slot_)
+			{
+				has_null_ = false;
+				null_slot_ = slot_type{};
+			}
+			else
+				erase_at(static_cast<std::size_t>(slot - slots_.data()));
+			--size_;
+		}
+
+		/*
+		backward shift deletion, every later key of the run which may live at pos moves there.
+		*/
+		void erase_at(std::size_t pos)
+		{
+			std::size_t mask = slots_.size() - 1;
+			for(std::size_t next = (pos + 1) & mask; !key_of(slots_[next]).is_null(); next = (next + 1) & mask)
+			{
+				// keys whose home lies cyclically in (pos, next] have to stay
+				std::size_t home = home_of(key_of(slots_[next]));
+				if(((next - home) & mask) >= ((next - pos) & mask))
+				{
+					slots_[pos] = std::move(slots_[next]);
+					pos = next;
+				}
+			}
+			slots_[pos] = slot_type{};
+		}
+
+		void rehash(std::size_t capacity)
+		{
+			std::vector<slot_type, rebind_alloc<slot_type>> old_slots(capacity, slots_.get_allocator());
+			std::swap(old_slots, slots_);
+			std::size_t mask = capacity - 1;
+			for(slot_type &slot : old_slots)
+			{
+				if(key_of(slot).is_null())
+					continue;
+				std::size_t pos = home_of(key_of(slot));
+				while(!key_of(slots_[pos]).is_null())
+					pos = (pos + 1) & mask;
+				slots_[pos] = std::move(slot);
+			}
+		}
+
+		template<typename Self, typename Fn>
+		static void for_each_slot(Self &self, Fn &fn)
+		{
+			auto visit = [&fn](auto &slot) {
+				if constexpr(is_set)
+					fn(static_cast<const uuid &>(slot));
+				else
+					fn(static_cast<const uuid &>(slot.key), slot.value);
+			};
+			if(self.has_null_)
+				visit(self.null_slot_);
+			for(auto &slot : self.slots_)
+			{
+				if(!key_of(slot).is_null())
+					visit(slot);
+			}
+		}
+
+		std::vector<slot_type, rebind_alloc<slot_type>> slots_;
+		slot_type null_slot_{};
+		bool has_null_ = false;
+		std::size_t size_ = 0;
+	};
+
+	using uuid_set = basic_uuid_table<void>;
+
+	template<std::default_initializable Value, typename Allocator = std::allocator<std::byte>>
+	using uuid_map = basic_uuid_table<Value, Allocator>;
+
+	namespace pmr
+	{
+		using uuid_set = basic_uuid_table<void, std::pmr::polymorphic_allocator<std::byte>>;
+
+		template<std::default_initializable Value>
+		using uuid_map = basic_uuid_table<Value, std::pmr::polymorphic_allocator<std::byte>>;
+	} // namespace pmr
+} // namespace libsugarx
+
+#endif // LIBSUGARX_UUID_TABLE_H